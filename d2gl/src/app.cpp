@@ -18,8 +18,11 @@
 
 #include "pch.h"
 #include "d2/common.h"
+#include "graphic/asset_loader.h"
 #include "helpers.h"
+#include "modules/motion_prediction.h"
 #include "option/ini.h"
+#include "profiler.h"
 #include "win32.h"
 
 namespace d2gl {
@@ -66,6 +69,9 @@ void dllAttach(HMODULE hmodule)
 
 	App.log = command_line.find("-log") != std::string::npos;
 	App.direct = command_line.find("-direct") != std::string::npos;
+	App.motion_record = command_line.find("-motionrec") != std::string::npos;
+	App.motion_replay = command_line.find("-motionreplay") != std::string::npos;
+	App.profile = command_line.find("-profile") != std::string::npos;
 
 	logInit();
 	trace_log("Renderer Api: %s", App.api == Api::Glide ? "Glide" : "DDraw");
@@ -98,12 +104,26 @@ void dllAttach(HMODULE hmodule)
 	App.hmodule = hmodule;
 
 	option::loadIni();
+	if (App.motion_replay)
+		modules::MotionPrediction::Instance().replay(App.motion_record_file);
+
+	if (App.profile) {
+		Profiler::Instance().toggle(true);
+		Profiler::Instance().startCapture(App.profile_file);
+	}
+
 	helpers::loadDlls(App.dlls_early);
 
 	d2::initHooks();
 	win32::initHooks();
 }
 
+// Called by the game's own shutdown, before the loader lock is held.
+void dllShutdown()
+{
+	AssetLoader::Instance().shutdown();
+}
+
 void dllDetach()
 {
 	if (App.hmodule) {
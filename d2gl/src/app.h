@@ -37,12 +37,17 @@ struct D2GLApp {
 	bool video_test = false;
 	bool ready = false;
 	bool direct = false;
+	bool motion_record = false;
+	bool motion_replay = false;
+	bool profile = false;
 
 	std::string menu_title = "D2GL";
 	std::string version_str = "1.3.3";
 	std::string ini_file = "d2gl.ini";
 	std::string mpq_file = "d2gl.mpq";
 	std::string log_file = "d2gl.log";
+	std::string motion_record_file = "d2gl_motion.rec";
+	std::string profile_file = "d2gl_profile";
 
 	Api api = Api::Glide;
 	std::unique_ptr<Context> context;
@@ -54,6 +59,9 @@ struct D2GLApp {
 	GLCaps gl_caps;
 	glm::vec<2, uint8_t> gl_ver = { 4, 6 };
 	bool use_compute_shader = false;
+	bool instanced_mod = true;
+	bool ddraw_row_hash = true;
+	bool ddraw_zero_copy = false;
 
 	HMODULE hmodule = 0;
 	WNDPROC wndproc = 0;
@@ -117,6 +125,10 @@ struct D2GLApp {
 		Select<std::string> presets = {};
 		std::string preset = "bilinear.slangp";
 		int selected = 0;
+		struct {
+			bool active = false;
+			Range<float> budget = { 8.0f, 2.0f, 30.0f };
+		} dynamic_res;
 	} shader;
 
 	Select<int> lut = {};
@@ -137,6 +149,7 @@ struct D2GLApp {
 		bool active = false;
 		Range<float> exposure = { 1.2f, 1.0f, 2.0f };
 		Range<float> gamma = { 1.0f, 0.5f, 1.2f };
+		Select<int> kernel = { 0, { { "Gaussian", 0 }, { "Dual Filter", 1 } } };
 	} bloom;
 
 	struct {
@@ -152,6 +165,15 @@ struct D2GLApp {
 	bool show_monster_res = false;
 	bool show_fps = false;
 
+	struct {
+		Select<int> type = { 0, { { "D2DX", 0 }, { "Alpha-Beta", 1 }, { "Kalman", 2 } } };
+		Range<int> correction = { 7000, 1000, 30000 };
+		Range<float> alpha = { 0.5f, 0.05f, 1.0f };
+		Range<float> beta = { 0.2f, 0.01f, 1.0f };
+		Range<float> process_noise = { 50.0f, 1.0f, 500.0f };
+		Range<float> measure_noise = { 0.01f, 0.001f, 0.5f };
+	} motion_predictor;
+
 	struct {
 		bool active = false;
 		bool centered = false;
@@ -189,6 +211,7 @@ extern D2GLApp App;
 
 void dllAttach(HMODULE hmodule);
 void dllDetach();
+void dllShutdown();
 
 constexpr inline bool ISGLIDE3X()
 {
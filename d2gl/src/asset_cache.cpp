@@ -0,0 +1,189 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "asset_cache.h"
+#include "d2/common.h"
+#include "helpers.h"
+
+namespace d2gl {
+
+Asset::Asset(const uint8_t* data, size_t size, HANDLE mapping)
+	: m_data(data), m_size(size), m_mapping(mapping)
+{}
+
+Asset::~Asset()
+{
+	if (m_mapping) {
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mapping);
+	} else
+		delete[] m_data;
+}
+
+AssetRef AssetCache::load(const std::string& file_path, bool optional)
+{
+	// Direct mode maps the file on every load, so edits on disk show up on the next reload and the
+	// mapping is dropped with the last reference instead of keeping the file locked.
+	if (App.direct) {
+		if (auto asset = mapFile(file_path))
+			return asset;
+	}
+
+	std::string key = file_path;
+	helpers::strToLower(key);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (auto it = m_entries.find(key); it != m_entries.end()) {
+			it->second.last_used = ++m_tick;
+			m_stats.hits++;
+			return it->second.asset;
+		}
+	}
+
+	AssetRef asset = readFile(file_path, optional);
+	if (!asset)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.misses++;
+	if (asset->getSize() > ASSET_CACHE_MAX_SIZE)
+		return asset;
+
+	auto it = m_entries.find(key);
+	if (it != m_entries.end())
+		return it->second.asset;
+
+	m_entries.insert({ key, { asset, ++m_tick } });
+	m_stats.count++;
+	m_stats.memory += asset->getSize();
+	trim();
+
+	return asset;
+}
+
+void AssetCache::clear()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_stats.count = 0;
+	m_stats.memory = 0;
+}
+
+AssetCacheStats AssetCache::getStats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void AssetCache::logStats()
+{
+	const auto stats = getStats();
+	trace_log("AssetCache: %d hits, %d misses, %d evictions, %d files (%.2f MB) cached.", stats.hits, stats.misses, stats.evictions, stats.count, (float)stats.memory / (1024 * 1024));
+}
+
+void AssetCache::trim()
+{
+	// Only drop files nobody holds, least recently used first.
+	while (m_stats.memory > ASSET_CACHE_MAX_SIZE) {
+		auto oldest = m_entries.end();
+		for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+			if (it->second.asset.use_count() == 1 && (oldest == m_entries.end() || it->second.last_used < oldest->second.last_used))
+				oldest = it;
+		}
+		if (oldest == m_entries.end())
+			break;
+
+		m_stats.memory -= oldest->second.asset->getSize();
+		m_stats.count--;
+		m_stats.evictions++;
+		m_entries.erase(oldest);
+	}
+}
+
+AssetRef AssetCache::mapFile(const std::string& file_path)
+{
+	const std::string path = helpers::getCurrentDir() + "data\\" + file_path;
+
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER size = { 0 };
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0 || size.HighPart) {
+		CloseHandle(file);
+		return nullptr;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping)
+		return nullptr;
+
+	auto view = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		return nullptr;
+	}
+
+	return std::make_shared<const Asset>(view, (size_t)size.QuadPart, mapping);
+}
+
+AssetRef AssetCache::readFile(const std::string& file_path, bool optional)
+{
+	static std::mutex mpq_mutex;
+	std::lock_guard<std::mutex> lock(mpq_mutex);
+
+	static bool is_mpq_loaded = false;
+	if (!is_mpq_loaded) {
+		std::string mpq_path = helpers::getCurrentDir() + App.mpq_file;
+		if (!d2::mpqLoad(mpq_path.c_str()))
+			error_log("%s not loaded.", mpq_path.c_str());
+		is_mpq_loaded = true;
+	}
+
+	std::string path = std::string("data\\").append(file_path);
+
+	void* ref_file;
+	char c_filepath[MAX_PATH];
+	strncpy_s(c_filepath, path.c_str(), path.size());
+
+	if (d2::mpqOpenFile && d2::mpqOpenFile(c_filepath, &ref_file)) {
+		size_t return_size = 0;
+		DWORD fileSize = d2::mpqGetFileSize(ref_file, NULL);
+		uint8_t* cache = new uint8_t[fileSize + 1];
+
+		if (d2::mpqReadFile(ref_file, cache, fileSize, &return_size, NULL, NULL, NULL)) {
+			d2::mpqCloseFile(ref_file);
+
+			cache[fileSize] = 0;
+			return std::make_shared<const Asset>(cache, return_size);
+		} else
+			error_log("File (MPQ): \"%s\" read error.", path.c_str());
+
+		delete[] cache;
+		return nullptr;
+	} else if (!optional)
+		error_log("File (MPQ): \"%s\" could not opened!", path.c_str());
+
+	return nullptr;
+}
+
+}
@@ -0,0 +1,85 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+namespace d2gl {
+
+#define ASSET_CACHE_MAX_SIZE 32 * 1024 * 1024
+
+class Asset {
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+	HANDLE m_mapping = NULL;
+
+public:
+	Asset(const uint8_t* data, size_t size, HANDLE mapping = NULL);
+	~Asset();
+
+	inline const uint8_t* getData() const { return m_data; }
+	inline const size_t getSize() const { return m_size; }
+	inline const bool isMapped() const { return m_mapping != NULL; }
+	inline std::string getString() const { return std::string((const char*)m_data, m_size); }
+};
+
+typedef std::shared_ptr<const Asset> AssetRef;
+
+struct AssetCacheStats {
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	uint32_t evictions = 0;
+	uint32_t count = 0;
+	size_t memory = 0;
+};
+
+class AssetCache {
+	struct Entry {
+		AssetRef asset;
+		uint64_t last_used = 0;
+	};
+
+	std::unordered_map<std::string, Entry> m_entries;
+	std::mutex m_mutex;
+	uint64_t m_tick = 0;
+	AssetCacheStats m_stats;
+
+	AssetCache() = default;
+	~AssetCache() = default;
+
+	void trim();
+
+public:
+	static AssetCache& Instance()
+	{
+		static AssetCache instance;
+		return instance;
+	}
+
+	AssetRef load(const std::string& file_path, bool optional = false);
+	void clear();
+
+	AssetCacheStats getStats();
+	void logStats();
+
+private:
+	static AssetRef mapFile(const std::string& file_path);
+	static AssetRef readFile(const std::string& file_path, bool optional);
+};
+
+}
@@ -20,8 +20,10 @@
 #include "funcs.h"
 #include "common.h"
 #include "helpers.h"
+#include "modules/hd_cursor.h"
 #include "modules/hd_text.h"
 #include "modules/motion_prediction.h"
+#include "profiler.h"
 #include "stubs.h"
 
 namespace d2gl::d2 {
@@ -220,7 +222,8 @@ void uiDrawEnd()
 
 void __stdcall drawImageHooked(CellContext* cell, int x, int y, uint32_t gamma, int draw_mode, uint8_t* palette)
 {
-	if (App.hd_cursor && App.game.draw_stage >= DrawStage::Cursor)
+	const ProfileScope scope(ProfileHook::Image);
+	if (App.hd_cursor && App.game.draw_stage >= DrawStage::Cursor && modules::HDCursor::Instance().isReady())
 		return;
 
 	if (modules::HDText::Instance().drawImage(cell, x, y, draw_mode)) {
@@ -233,12 +236,14 @@ void __stdcall drawImageHooked(CellContext* cell, int x, int y, uint32_t gamma,
 
 void __stdcall drawPerspectiveImageHooked(CellContext* cell, int x, int y, uint32_t gamma, int draw_mode, int screen_mode, uint8_t* palette)
 {
+	const ProfileScope scope(ProfileHook::PerspectiveImage);
 	const auto pos = modules::MotionPrediction::Instance().drawImage(x, y, D2DrawFn::PerspectiveImage);
 	drawPerspectiveImage(cell, pos.x, pos.y, gamma, draw_mode, screen_mode, palette);
 }
 
 void __stdcall drawShiftedImageHooked(CellContext* cell, int x, int y, uint32_t gamma, int draw_mode, int global_palette_shift)
 {
+	const ProfileScope scope(ProfileHook::ShiftedImage);
 	if (modules::HDText::Instance().drawShiftedImage(cell, x, y)) {
 		auto pos = modules::MotionPrediction::Instance().drawImage(x, y, D2DrawFn::ShiftedImage);
 		drawShiftedImage(cell, pos.x, pos.y, gamma, draw_mode, global_palette_shift);
@@ -247,6 +252,7 @@ void __stdcall drawShiftedImageHooked(CellContext* cell, int x, int y, uint32_t
 
 void __stdcall drawVerticalCropImageHooked(CellContext* cell, int x, int y, int skip_lines, int draw_lines, int draw_mode)
 {
+	const ProfileScope scope(ProfileHook::VerticalCropImage);
 	if (modules::HDText::Instance().isActive() && App.game.draw_stage >= DrawStage::UI) {
 		if (y < 150 || (*d2::screen_shift >= SCREENPANEL_LEFT && y < (int)*d2::screen_height - 100 && x < (int)*d2::screen_width / 2))
 			return;
@@ -258,24 +264,28 @@ void __stdcall drawVerticalCropImageHooked(CellContext* cell, int x, int y, int
 
 void __stdcall drawClippedImageHooked(CellContext* cell, int x, int y, void* crop_rect, int draw_mode)
 {
+	const ProfileScope scope(ProfileHook::ClippedImage);
 	const auto pos = modules::MotionPrediction::Instance().drawImage(x, y, D2DrawFn::ClippedImage);
 	drawClippedImage(cell, pos.x, pos.y, crop_rect, draw_mode);
 }
 
 void __stdcall drawImageFastHooked(CellContext* cell, int x, int y, uint8_t palette_index)
 {
+	const ProfileScope scope(ProfileHook::ImageFast);
 	const auto pos = modules::MotionPrediction::Instance().drawImage(x, y, D2DrawFn::ImageFast);
 	drawImageFast(cell, pos.x, pos.y, palette_index);
 }
 
 void __stdcall drawShadowHooked(CellContext* cell, int x, int y)
 {
+	const ProfileScope scope(ProfileHook::Shadow);
 	const auto pos = modules::MotionPrediction::Instance().drawImage(x, y, D2DrawFn::Shadow);
 	drawShadow(cell, pos.x, pos.y);
 }
 
 void __stdcall drawSolidRectExHooked(int left, int top, int right, int bottom, uint32_t color, int draw_mode)
 {
+	const ProfileScope scope(ProfileHook::SolidRect);
 	auto offset = modules::MotionPrediction::Instance().drawSolidRect();
 	if (!modules::HDText::Instance().drawSolidRect(left - offset.x, top - offset.y, right - offset.x, bottom - offset.y, color, draw_mode))
 		drawSolidRectEx(left - offset.x, top - offset.y, right - offset.x, bottom - offset.y, color, draw_mode);
@@ -285,12 +295,14 @@ void __stdcall drawSolidRectExHooked(int left, int top, int right, int bottom, u
 
 void __stdcall drawLineHooked(int x_start, int y_start, int x_end, int y_end, uint8_t color, uint8_t alpha)
 {
+	const ProfileScope scope(ProfileHook::Line);
 	const auto offset = modules::MotionPrediction::Instance().drawLine(x_start, y_start);
 	drawLine(x_start - offset.x, y_start - offset.y, x_end - offset.x, y_end - offset.y, color, alpha);
 }
 
 bool __stdcall drawGroundTileHooked(TileContext* tile, GFXLight* light, int x, int y, int world_x, int world_y, uint8_t alpha, int screen_panels, bool tile_data)
 {
+	const ProfileScope scope(ProfileHook::GroundTile);
 	// Drawing invisible tile crashes on glide mode.
 	if (ISGLIDE3X() && tile) {
 		const auto len = strlen(tile->szTileName);
@@ -307,18 +319,21 @@ bool __stdcall drawGroundTileHooked(TileContext* tile, GFXLight* light, int x, i
 
 bool __stdcall drawWallTileHooked(TileContext* tile, int x, int y, GFXLight* light, int screen_panels)
 {
+	const ProfileScope scope(ProfileHook::WallTile);
 	const auto offset = modules::MotionPrediction::Instance().getGlobalOffset(true);
 	return drawWallTile(tile, x - offset.x, y - offset.y, light, screen_panels);
 }
 
 bool __stdcall drawTransWallTileHooked(TileContext* tile, int x, int y, GFXLight* light, int screen_panels, uint8_t alpha)
 {
+	const ProfileScope scope(ProfileHook::TransWallTile);
 	const auto offset = modules::MotionPrediction::Instance().getGlobalOffset(true);
 	return drawTransWallTile(tile, x - offset.x, y - offset.y, light, screen_panels, alpha);
 }
 
 bool __stdcall drawShadowTileHooked(TileContext* tile, int x, int y, int draw_mode, int screen_panels)
 {
+	const ProfileScope scope(ProfileHook::ShadowTile);
 	const auto offset = modules::MotionPrediction::Instance().getGlobalOffset(true);
 	return drawShadowTile(tile, x - offset.x, y - offset.y, draw_mode, screen_panels);
 }
@@ -330,8 +345,9 @@ void __fastcall takeScreenShotHooked()
 
 void __fastcall drawNormalTextHooked(const wchar_t* str, int x, int y, uint32_t color, uint32_t centered)
 {
+	const ProfileScope scope(ProfileHook::NormalText);
 	// Glide mode light gray text appears black. So direct to dark gray.
-	if (ISGLIDE3X() && !App.hd_text.active && color == 15)
+	if (ISGLIDE3X() && !modules::HDText::Instance().isActive() && color == 15)
 		color = 5;
 
 	const auto pos = modules::MotionPrediction::Instance().drawText(str, x, y, D2DrawFn::NormalText);
@@ -341,6 +357,7 @@ void __fastcall drawNormalTextHooked(const wchar_t* str, int x, int y, uint32_t
 
 void __fastcall drawNormalTextExHooked(const wchar_t* str, int x, int y, uint32_t color, uint32_t centered, uint32_t trans_lvl)
 {
+	const ProfileScope scope(ProfileHook::NormalTextEx);
 	const auto pos = modules::MotionPrediction::Instance().drawText(str, x, y, D2DrawFn::NormalTextEx);
 	if (!modules::HDText::Instance().drawText(str, pos.x, pos.y, color, centered, trans_lvl))
 		drawNormalTextEx(str, pos.x, pos.y, color, centered, trans_lvl);
@@ -348,6 +365,7 @@ void __fastcall drawNormalTextExHooked(const wchar_t* str, int x, int y, uint32_
 
 void __fastcall drawFramedTextHooked(const wchar_t* str, int x, int y, uint32_t color, uint32_t centered)
 {
+	const ProfileScope scope(ProfileHook::FramedText);
 	const auto pos = modules::MotionPrediction::Instance().drawText(str, x, y, D2DrawFn::FramedText);
 	if (!modules::HDText::Instance().drawFramedText(str, pos.x, pos.y, color, centered))
 		drawFramedText(str, pos.x, pos.y, color, centered);
@@ -355,6 +373,7 @@ void __fastcall drawFramedTextHooked(const wchar_t* str, int x, int y, uint32_t
 
 void __fastcall drawRectangledTextHooked(const wchar_t* str, int x, int y, uint32_t rect_color, uint32_t rect_transparency, uint32_t color)
 {
+	const ProfileScope scope(ProfileHook::RectangledText);
 	const auto pos = modules::MotionPrediction::Instance().drawText(str, x, y, D2DrawFn::RectangledText);
 	if (!modules::HDText::Instance().drawRectangledText(str, pos.x, pos.y, rect_transparency, color))
 		drawRectangledText(str, pos.x, pos.y, rect_color, rect_transparency, color);
@@ -362,6 +381,7 @@ void __fastcall drawRectangledTextHooked(const wchar_t* str, int x, int y, uint3
 
 uint32_t __fastcall getNormalTextWidthHooked(const wchar_t* str)
 {
+	const ProfileScope scope(ProfileHook::TextSize);
 	if (modules::HDText::Instance().isActive())
 		return modules::HDText::Instance().getNormalTextWidth(str, 0);
 	return getNormalTextWidth(str);
@@ -369,6 +389,7 @@ uint32_t __fastcall getNormalTextWidthHooked(const wchar_t* str)
 
 uint32_t __fastcall getNormalTextNWidthHooked(const wchar_t* str, const int n_chars)
 {
+	const ProfileScope scope(ProfileHook::TextSize);
 	if (modules::HDText::Instance().isActive())
 		return modules::HDText::Instance().getNormalTextWidth(str, n_chars);
 	return getNormalTextNWidth(str, n_chars);
@@ -376,6 +397,7 @@ uint32_t __fastcall getNormalTextNWidthHooked(const wchar_t* str, const int n_ch
 
 uint32_t __fastcall getFramedTextSizeHooked(const wchar_t* str, uint32_t* width, uint32_t* height)
 {
+	const ProfileScope scope(ProfileHook::TextSize);
 	if (modules::HDText::Instance().isActive())
 		return modules::HDText::Instance().getFramedTextSize(str, width, height);
 	return getFramedTextSize(str, width, height);
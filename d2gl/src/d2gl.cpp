@@ -18,6 +18,13 @@
 
 #include "pch.h"
 #include "d2gl.h"
+#include "modules/hd_text.h"
+
+// HDText is created with the GL context, it can not be asked before that.
+static bool isHDTextActive()
+{
+	return d2gl::App.context && d2gl::modules::HDText::Instance().isActive();
+}
 
 #ifdef __cplusplus
 extern "C" {
@@ -29,7 +36,7 @@ __declspec(dllexport) BOOL __stdcall d2glConfigQueryImpl(D2GLConfigId config_id)
 		case D2GL_CONFIG_VSYNC: return d2gl::App.vsync;
 		case D2GL_CONFIG_CURSOR_UNLOCKED: return d2gl::App.cursor.unlock;
 		case D2GL_CONFIG_HD_CURSOR: return d2gl::App.hd_cursor;
-		case D2GL_CONFIG_HD_TEXT: return d2gl::App.hd_text.active;
+		case D2GL_CONFIG_HD_TEXT: return isHDTextActive();
 		case D2GL_CONFIG_MOTION_PREDICTION: return d2gl::App.motion_prediction;
 		case D2GL_CONFIG_MINI_MAP: return d2gl::App.mini_map.active;
 		case D2GL_CONFIG_SHOW_ITEM_QUANTITY: return d2gl::App.show_item_quantity;
@@ -46,7 +53,7 @@ __declspec(dllexport) void __stdcall setCustomScreenSize(uint32_t width, uint32_
 
 __declspec(dllexport) bool isHDTextEnabled()
 {
-    return d2gl::App.hd_text.active;
+    return isHDTextActive();
 }
 
 #ifdef __cplusplus
@@ -0,0 +1,141 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "asset_loader.h"
+#include "helpers.h"
+
+namespace d2gl {
+
+AssetLoader::AssetLoader()
+{
+	startWorkers();
+}
+
+// Static destruction can run under the loader lock where a join would dead lock,
+// by then the process is exiting and the workers are already gone.
+AssetLoader::~AssetLoader()
+{
+	for (auto& worker : m_workers) {
+		if (worker.joinable())
+			worker.detach();
+	}
+}
+
+// Workers finish the queued jobs first, a later run() starts them again.
+void AssetLoader::shutdown()
+{
+	std::vector<std::thread> workers;
+	{
+		std::lock_guard<std::mutex> lock(m_jobs_mutex);
+		m_stop = true;
+		workers.swap(m_workers);
+	}
+	m_jobs_cv.notify_all();
+
+	for (auto& worker : workers) {
+		if (worker.joinable())
+			worker.join();
+	}
+
+	std::lock_guard<std::mutex> lock(m_jobs_mutex);
+	m_stop = false;
+}
+
+void AssetLoader::startWorkers()
+{
+	const uint32_t threads = std::thread::hardware_concurrency();
+	const uint32_t count = glm::clamp(threads > 1 ? threads - 1 : 1u, 1u, (uint32_t)ASSET_LOADER_MAX_THREADS);
+	for (uint32_t i = 0; i < count; i++)
+		m_workers.emplace_back(&AssetLoader::workerThread, this);
+
+	trace_log("AssetLoader: %d worker threads.", count);
+}
+
+void AssetLoader::workerThread()
+{
+	while (true) {
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_jobs_mutex);
+			m_jobs_cv.wait(lock, [this] { return m_stop || !m_jobs.empty(); });
+			if (m_stop && m_jobs.empty())
+				return;
+
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+		job();
+	}
+}
+
+void AssetLoader::run(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_jobs_mutex);
+		if (m_workers.empty())
+			startWorkers();
+		m_jobs.push_back(std::move(job));
+	}
+	m_jobs_cv.notify_one();
+}
+
+void AssetLoader::upload(std::function<void()> job)
+{
+	std::lock_guard<std::mutex> lock(m_uploads_mutex);
+	m_uploads.push_back(std::move(job));
+}
+
+void AssetLoader::processUploads(uint32_t max_count)
+{
+	for (uint32_t i = 0; i < max_count; i++) {
+		std::function<void()> job;
+		{
+			std::lock_guard<std::mutex> lock(m_uploads_mutex);
+			if (m_uploads.empty())
+				return;
+
+			job = std::move(m_uploads.front());
+			m_uploads.pop_front();
+		}
+		job();
+	}
+}
+
+std::future<ImageData> AssetLoader::loadImage(const std::string& file_path, bool flipped)
+{
+	auto task = std::make_shared<std::packaged_task<ImageData()>>([file_path, flipped]() { return helpers::loadImage(file_path, flipped); });
+	auto future = task->get_future();
+	run([task]() { (*task)(); });
+
+	return future;
+}
+
+void AssetLoader::loadImage(const std::string& file_path, bool flipped, std::function<void(const ImageData&)> on_upload)
+{
+	run([this, file_path, flipped, on_upload]() {
+		auto image = helpers::loadImage(file_path, flipped);
+		upload([image, on_upload]() mutable {
+			on_upload(image);
+			helpers::clearImage(image);
+		});
+	});
+}
+
+}
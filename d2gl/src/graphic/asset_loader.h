@@ -0,0 +1,61 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "types.h"
+
+namespace d2gl {
+
+#define ASSET_LOADER_MAX_THREADS 4
+#define ASSET_UPLOADS_PER_FRAME 4
+
+class AssetLoader {
+	std::vector<std::thread> m_workers;
+	std::deque<std::function<void()>> m_jobs;
+	std::mutex m_jobs_mutex;
+	std::condition_variable m_jobs_cv;
+	bool m_stop = false;
+
+	std::deque<std::function<void()>> m_uploads;
+	std::mutex m_uploads_mutex;
+
+	AssetLoader();
+	~AssetLoader();
+
+	void startWorkers();
+	void workerThread();
+
+public:
+	static AssetLoader& Instance()
+	{
+		static AssetLoader instance;
+		return instance;
+	}
+
+	void shutdown();
+	void run(std::function<void()> job);
+	void upload(std::function<void()> job);
+	void processUploads(uint32_t max_count = ASSET_UPLOADS_PER_FRAME);
+
+	std::future<ImageData> loadImage(const std::string& file_path, bool flipped = true);
+	void loadImage(const std::string& file_path, bool flipped, std::function<void(const ImageData&)> on_upload);
+};
+
+}
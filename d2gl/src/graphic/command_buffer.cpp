@@ -23,8 +23,9 @@ void CommandBuffer::reset()
 	m_tex_update_queue.count = 0;
 	m_tex_update_queue.data_offset = 0;
 	m_vertex_count = 0;
-	m_vertex_mod_count = 0;
+	m_quad_mod_count = 0;
 	m_tex_update.bit = 0;
+	m_tex_update.slice = -1;
 
 	m_screen = App.game.screen;
 	m_window_size = App.window.size;
@@ -87,11 +88,20 @@ void CommandBuffer::textureUpdate(uint8_t* data, uint16_t tex_num, glm::vec<2, u
 	m_tex_update_queue.count++;
 }
 
-void CommandBuffer::gameTextureUpdate(uint8_t* data, glm::vec<2, uint16_t> size, uint32_t bit)
+void CommandBuffer::gameTextureUpdate(uint8_t* data, glm::vec<2, uint16_t> size, uint32_t bit, uint16_t offset_y)
 {
-	memcpy(m_tex_buffer, data, size.x * size.y * bit);
+	memcpy(m_tex_buffer, data + offset_y * size.x * bit, size.x * size.y * bit);
 	m_tex_update.bit = bit;
 	m_tex_update.size = size;
+	m_tex_update.offset_y = offset_y;
+}
+
+void CommandBuffer::gameTextureSlice(int32_t slice, glm::vec<2, uint16_t> size, uint32_t bit)
+{
+	m_tex_update.bit = bit;
+	m_tex_update.size = size;
+	m_tex_update.offset_y = 0;
+	m_tex_update.slice = slice;
 }
 
 void CommandBuffer::setHDTextMasking(bool masking, glm::vec4 metrics)
@@ -55,6 +55,8 @@ struct UBOUpdateQueue {
 struct GameTexUpdate {
 	uint32_t bit = 0;
 	glm::vec<2, uint16_t> size = { 0, 0 };
+	uint16_t offset_y = 0;
+	int32_t slice = -1;
 };
 
 struct HDTextMasking {
@@ -71,7 +73,7 @@ class CommandBuffer {
 	UBOUpdateQueue m_ubo_update_queue;
 	TexUpdateQueue m_tex_update_queue;
 	uint32_t m_vertex_count = 0;
-	uint32_t m_vertex_mod_count = 0;
+	uint32_t m_quad_mod_count = 0;
 	GameScreen m_screen = GameScreen::InGame;
 
 	bool m_resized = false;
@@ -98,8 +100,11 @@ public:
 
 	void colorUpdate(UBOType type, const void* data);
 	void textureUpdate(uint8_t* data, uint16_t tex_num, glm::vec<2, uint16_t> size, glm::vec<2, uint16_t> offset);
-	void gameTextureUpdate(uint8_t* data, glm::vec<2, uint16_t> size, uint32_t bit = 1);
+	void gameTextureUpdate(uint8_t* data, glm::vec<2, uint16_t> size, uint32_t bit = 1, uint16_t offset_y = 0);
+	void gameTextureSlice(int32_t slice, glm::vec<2, uint16_t> size, uint32_t bit = 1);
 	void setHDTextMasking(bool masking, glm::vec4 metrics);
+
+	inline bool isResized() { return m_resized; }
 };
 
 }
\ No newline at end of file
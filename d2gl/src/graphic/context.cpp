@@ -18,13 +18,16 @@
 
 #include "pch.h"
 #include "context.h"
+#include "asset_cache.h"
 #include "d2/common.h"
+#include "gpu_timer.h"
 #include "helpers.h"
 #include "modules/hd_cursor.h"
 #include "modules/hd_text.h"
 #include "modules/mini_map.h"
 #include "modules/motion_prediction.h"
 #include "option/menu.h"
+#include "profiler.h"
 #include "upscaler.h"
 #include "win32.h"
 
@@ -123,6 +126,11 @@ Context::Context()
 		trace_log("OpenGL: Independent blending available.");
 	}
 
+	if (App.instanced_mod && (glewIsSupported("GL_VERSION_3_3") || glewIsSupported("GL_ARB_instanced_arrays"))) {
+		App.gl_caps.instanced_mod = true;
+		trace_log("OpenGL: Instanced mod quads enabled.");
+	}
+
 	glDisable(GL_CULL_FACE);
 	glDisable(GL_DEPTH_TEST);
 	glDisable(GL_STENCIL_TEST);
@@ -160,6 +168,30 @@ Context::Context()
 	glBufferData(GL_PIXEL_UNPACK_BUFFER, PIXEL_BUFFER_SIZE, NULL, GL_DYNAMIC_DRAW);
 	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
+	if (!ISGLIDE3X() && App.ddraw_zero_copy && (glewIsSupported("GL_VERSION_4_4") || glewIsSupported("GL_ARB_buffer_storage"))) {
+		// Game reads back what it draws, so ask for cached client memory.
+		const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		m_upload_slice_count = App.frame_latency + 3;
+
+		glGenBuffers(1, &m_upload_buffer);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_upload_buffer);
+		glBufferStorage(GL_PIXEL_UNPACK_BUFFER, m_upload_slice_count * UPLOAD_SLICE_SIZE, NULL, flags | GL_CLIENT_STORAGE_BIT);
+		m_upload_ptr = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, m_upload_slice_count * UPLOAD_SLICE_SIZE, flags);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		if (m_upload_ptr)
+			trace_log("OpenGL: Zero-copy surface enabled (%d slices).", m_upload_slice_count);
+		else {
+			glDeleteBuffers(1, &m_upload_buffer);
+			m_upload_buffer = 0;
+			m_upload_slice_count = 0;
+		}
+	}
+
+	std::future<ImageData> lut_image;
+	if (ISGLIDE3X())
+		lut_image = AssetLoader::Instance().loadImage("assets\\textures\\lut.png", false);
+
 	imguiInit();
 
 	PipelineCreateInfo movie_pipeline_ci = { "movie" };
@@ -189,7 +221,8 @@ Context::Context()
 		fxaa_pipeline_ci.shader = g_shader_postfx;
 		fxaa_pipeline_ci.version = { 4, 3 };
 		fxaa_pipeline_ci.bindings = {
-			{ BindingType::Texture, "u_InTexture", TEXTURE_SLOT_POSTFX2, &m_postfx_texture },
+			{ BindingType::UniformBuffer, "ubo_Metrics", m_postfx_ubo->getBinding() },
+			{ BindingType::FBTexture, "u_InTexture", TEXTURE_SLOT_POSTFX1, &m_postfx_framebuffer },
 			{ BindingType::Image, "u_OutTexture", IMAGE_UNIT_FXAA },
 		};
 		fxaa_pipeline_ci.compute = true;
@@ -197,7 +230,7 @@ Context::Context()
 	}
 
 	PipelineCreateInfo mod_pipeline_ci = { "module" };
-	mod_pipeline_ci.shader = g_shader_mod;
+	mod_pipeline_ci.shader = App.gl_caps.instanced_mod ? g_shader_mod_instanced : g_shader_mod;
 	mod_pipeline_ci.attachment_blends = { { BlendType::SAlpha_OneMinusSAlpha } };
 	mod_pipeline_ci.bindings = {
 		{ BindingType::Texture, "u_CursorTexture", TEXTURE_SLOT_CURSOR },
@@ -210,6 +243,9 @@ Context::Context()
 	m_mod_pipeline = Context::createPipeline(mod_pipeline_ci);
 	m_mod_pipeline->setUniform1i("u_IsGlide", ISGLIDE3X());
 
+	if (!App.gl_caps.instanced_mod)
+		m_vertices_mod.resize(MAX_QUADS_MOD * 4);
+
 	if (ISGLIDE3X()) {
 		TextureCreateInfo glide_texture_ci;
 		glide_texture_ci.size = { 512, 512 };
@@ -245,7 +281,7 @@ Context::Context()
 		lut_texture_ci.slot = TEXTURE_SLOT_LUT;
 		m_lut_texture = Context::createTexture(lut_texture_ci);
 
-		auto image_data = helpers::loadImage("assets\\textures\\lut.png", false);
+		auto image_data = lut_image.get();
 		m_lut_texture->fillImage(image_data, 1, 14);
 		helpers::clearImage(image_data);
 
@@ -254,8 +290,8 @@ Context::Context()
 			blur_pipeline_ci.shader = g_shader_prefx;
 			blur_pipeline_ci.version = { 4, 3 };
 			blur_pipeline_ci.bindings = {
-				{ BindingType::Texture, "u_InTexture", TEXTURE_SLOT_BLOOM2, &m_bloom_texture },
-				{ BindingType::Image, "u_OutTexture", IMAGE_UNIT_BLUR },
+				{ BindingType::FBTexture, "u_InTexture", TEXTURE_SLOT_BLOOM1, &m_bloom_framebuffer },
+				{ BindingType::Image, "u_OutTexture", IMAGE_UNIT_BLUR2 },
 			};
 			blur_pipeline_ci.compute = true;
 			m_blur_compute_pipeline = Context::createPipeline(blur_pipeline_ci);
@@ -274,7 +310,7 @@ Context::Context()
 			{ BindingType::UniformBuffer, "ubo_Metrics", m_bloom_ubo->getBinding() },
 			{ BindingType::Texture, "u_Texture", TEXTURE_SLOT_PREFX, &m_prefx_texture },
 			{ BindingType::FBTexture, "u_BloomTexture1", TEXTURE_SLOT_BLOOM1, &m_bloom_framebuffer },
-			{ BindingType::Texture, "u_BloomTexture2", TEXTURE_SLOT_BLOOM2, &m_bloom_texture },
+			{ BindingType::FBTexture, "u_BloomSource", TEXTURE_SLOT_BLOOM2, &m_bloom_pong_framebuffer },
 			{ BindingType::Texture, "u_LUTTexture", m_lut_texture->getSlot(), &m_lut_texture },
 		};
 		m_prefx_pipeline = Context::createPipeline(prefx_pipeline_ci);
@@ -304,8 +340,8 @@ Context::Context()
 	m_limiter.timer = CreateWaitableTimer(NULL, TRUE, NULL);
 	setFpsLimit(!App.vsync && App.foreground_fps.active, App.foreground_fps.range.value);
 
-	m_vertices_mod.count = 0;
-	m_vertices_mod.ptr = m_vertices_mod.data[m_frame_index].data();
+	m_quads_mod.count = 0;
+	m_quads_mod.ptr = m_quads_mod.data[m_frame_index].data();
 
 	m_frame.vertex_count = 0;
 	m_frame.drawcall_count = 0;
@@ -332,8 +368,20 @@ Context::~Context()
 	for (uint32_t i = 0; i < MAX_FRAME_LATENCY; i++)
 		WaitForSingleObject(m_semaphore_gpu[i], INFINITE);
 
+	AssetCache::Instance().logStats();
+	AssetCache::Instance().clear();
+
 	wglMakeCurrent(App.hdc, m_context);
 	imguiDestroy();
+	GpuTimer::Instance().destroy();
+
+	if (m_upload_buffer) {
+		for (auto& fence : m_upload_fences)
+			glDeleteSync(fence.second);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_upload_buffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glDeleteBuffers(1, &m_upload_buffer);
+	}
 
 	glDeleteBuffers(1, &m_pixel_buffer);
 	glDeleteBuffers(1, &m_vertex_buffer);
@@ -356,13 +404,19 @@ void Context::renderThread(void* context)
 	while (ctx->m_rendering) {
 		WaitForSingleObject(ctx->m_semaphore_cpu[frame_index], INFINITE);
 		const auto cmd = &ctx->m_command_buffer[frame_index];
+		const uint64_t render_start = Profiler::Instance().isActive() ? __rdtsc() : 0;
+		auto& gpu_timer = GpuTimer::Instance();
+		gpu_timer.beginFrame(render_start != 0, render_start);
 
 		if (cmd->m_resized)
 			ctx->onResize(cmd->m_window_size, cmd->m_game_size, cmd->m_game_tex_bpp);
 
+		AssetLoader::Instance().processUploads();
+
 		if (ctx->m_current_shader != App.shader.selected)
 			ctx->onShaderChange();
 
+		gpu_timer.begin(GpuStage::Upload);
 		if (cmd->m_vertex_count)
 			glBufferSubData(GL_ARRAY_BUFFER, 0, cmd->m_vertex_count * sizeof(Vertex), ctx->m_vertices.data[frame_index].data());
 
@@ -376,12 +430,23 @@ void Context::renderThread(void* context)
 			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 		}
 
+		if (ctx->m_upload_buffer)
+			ctx->collectUploadFences();
+
 		if (cmd->m_tex_update.bit && ctx->m_game_texture) {
-			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ctx->m_pixel_buffer);
-			glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, cmd->m_tex_update.size.x * cmd->m_tex_update.size.y * cmd->m_tex_update.bit, cmd->m_tex_buffer);
-			ctx->m_game_texture->fill(0, cmd->m_tex_update.size.x, cmd->m_tex_update.size.y);
+			const int slice = cmd->m_tex_update.slice;
+			if (slice >= 0) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ctx->m_upload_buffer);
+				ctx->m_game_texture->fill((uint8_t*)(slice * UPLOAD_SLICE_SIZE), cmd->m_tex_update.size.x, cmd->m_tex_update.size.y);
+				ctx->m_upload_fences.push_back({ slice, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+			} else {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ctx->m_pixel_buffer);
+				glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, cmd->m_tex_update.size.x * cmd->m_tex_update.size.y * cmd->m_tex_update.bit, cmd->m_tex_buffer);
+				ctx->m_game_texture->fill(0, cmd->m_tex_update.size.x, cmd->m_tex_update.size.y, 0, cmd->m_tex_update.offset_y);
+			}
 			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-		}
+		} else if (cmd->m_tex_update.slice >= 0)
+			ctx->releaseUploadSlice(cmd->m_tex_update.slice);
 
 		Vertex::bindingDescription();
 		const glm::ivec2 vp_size = { App.viewport.stretched.x ? App.window.size.x : App.viewport.size.x, App.viewport.stretched.y ? App.window.size.y : App.viewport.size.y };
@@ -399,38 +464,42 @@ void Context::renderThread(void* context)
 					ctx->bindPipeline(ctx->m_game_pipeline, command->index);
 					break;
 				case CommandType::DrawIndexed:
+					gpu_timer.begin(GpuStage::Draw);
 					if (command->draw.count > 0)
 						glDrawElementsBaseVertex(GL_TRIANGLES, command->draw.count, GL_UNSIGNED_INT, 0, command->draw.start);
 					break;
 				case CommandType::PreFx:
+					gpu_timer.begin(GpuStage::PreFx);
 					ctx->m_prefx_texture->fillFromBuffer(ctx->m_game_framebuffer);
 					ctx->bindPipeline(ctx->m_prefx_pipeline);
 
 					if (App.bloom.active) {
+						gpu_timer.begin(GpuStage::Bloom);
 						ctx->bindFrameBuffer(ctx->m_bloom_framebuffer, false);
 						ctx->setViewport(ctx->m_bloom_tex_size);
 						ctx->drawQuad();
 
-						if (App.gl_caps.compute_shader) {
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->m_blur_compute_pipeline->dispatchCompute(0, ctx->m_bloom_work_size, GL_PIXEL_BUFFER_BARRIER_BIT);
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->m_blur_compute_pipeline->dispatchCompute(1, ctx->m_bloom_work_size, GL_PIXEL_BUFFER_BARRIER_BIT);
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->m_blur_compute_pipeline->dispatchCompute(0, ctx->m_bloom_work_size, GL_PIXEL_BUFFER_BARRIER_BIT);
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->m_blur_compute_pipeline->dispatchCompute(1, ctx->m_bloom_work_size, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+						if (App.bloom.kernel.selected == 1) {
+							const auto& mips = ctx->m_bloom_mip_framebuffers;
+							ctx->drawBloomPass(ctx->m_bloom_framebuffer, mips[0], 5);
+							for (size_t i = 1; i < mips.size(); i++)
+								ctx->drawBloomPass(mips[i - 1], mips[i], 5);
+							for (size_t i = mips.size() - 1; i > 0; i--)
+								ctx->drawBloomPass(mips[i], mips[i - 1], 6);
+							ctx->drawBloomPass(mips[0], ctx->m_bloom_framebuffer, 6);
+						} else if (App.gl_caps.compute_shader) {
+							ctx->dispatchBloomBlur(ctx->m_bloom_framebuffer, IMAGE_UNIT_BLUR2, 0, GL_TEXTURE_FETCH_BARRIER_BIT);
+							ctx->dispatchBloomBlur(ctx->m_bloom_pong_framebuffer, IMAGE_UNIT_BLUR, 1, GL_TEXTURE_FETCH_BARRIER_BIT);
+							ctx->dispatchBloomBlur(ctx->m_bloom_framebuffer, IMAGE_UNIT_BLUR2, 0, GL_TEXTURE_FETCH_BARRIER_BIT);
+							ctx->dispatchBloomBlur(ctx->m_bloom_pong_framebuffer, IMAGE_UNIT_BLUR, 1, GL_TEXTURE_FETCH_BARRIER_BIT);
 						} else {
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->drawQuad(1);
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->drawQuad(2);
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->drawQuad(1);
-							ctx->m_bloom_texture->fillFromBuffer(ctx->m_bloom_framebuffer);
-							ctx->drawQuad(2);
+							ctx->drawBloomPass(ctx->m_bloom_framebuffer, ctx->m_bloom_pong_framebuffer, 1);
+							ctx->drawBloomPass(ctx->m_bloom_pong_framebuffer, ctx->m_bloom_framebuffer, 2);
+							ctx->drawBloomPass(ctx->m_bloom_framebuffer, ctx->m_bloom_pong_framebuffer, 1);
+							ctx->drawBloomPass(ctx->m_bloom_pong_framebuffer, ctx->m_bloom_framebuffer, 2);
 						}
 
+						gpu_timer.begin(GpuStage::PreFx);
 						ctx->bindFrameBuffer(ctx->m_game_framebuffer, false);
 						ctx->setViewport(cmd->m_game_size);
 						ctx->bindPipeline(ctx->m_prefx_pipeline);
@@ -442,6 +511,7 @@ void Context::renderThread(void* context)
 					FrameBuffer::setDrawBuffers(ctx->m_game_framebuffer->getAttachmentCount());
 					break;
 				case CommandType::Begin:
+					gpu_timer.begin(GpuStage::Begin);
 					if (cmd->m_screen == GameScreen::Movie) {
 						ctx->bindDefaultFrameBuffer();
 						ctx->setViewport(App.window.size);
@@ -451,6 +521,7 @@ void Context::renderThread(void* context)
 					}
 					break;
 				case CommandType::Submit:
+					gpu_timer.begin(GpuStage::Draw);
 					if (cmd->m_screen == GameScreen::Movie) {
 						ctx->bindPipeline(ctx->m_movie_pipeline);
 						ctx->drawQuad();
@@ -476,42 +547,57 @@ void Context::renderThread(void* context)
 							ctx->drawQuad();
 						}
 
+						gpu_timer.end();
 						if (App.sharpen.active || App.fxaa.active)
 							Upscaler::Instance().process(ctx->m_game_framebuffer, vp_size, vp_offset, ctx->m_postfx_framebuffer);
 						else
 							Upscaler::Instance().process(ctx->m_game_framebuffer, vp_size, vp_offset);
 
-						if (App.sharpen.active) {
-							if (App.fxaa.active)
-								ctx->m_postfx_texture->fillFromBuffer(ctx->m_postfx_framebuffer);
-							else {
-								ctx->bindDefaultFrameBuffer();
-								ctx->setViewport(vp_size, vp_offset);
-							}
-							ctx->bindPipeline(ctx->m_postfx_pipeline);
-							ctx->drawQuad(App.fxaa.active);
-						}
+						if (App.fxaa.active || App.sharpen.active)
+							gpu_timer.begin(GpuStage::PostFx);
 
 						if (App.fxaa.active) {
-							if (App.gl_caps.compute_shader) {
+							const int preset = App.fxaa.presets.selected;
+							if (App.gl_caps.compute_shader)
+								ctx->m_fxaa_compute_pipeline->dispatchCompute(preset | (App.sharpen.active ? 4 : 0), ctx->m_fxaa_work_size, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+							else if (App.sharpen.active) {
+								// Fused taps would sharpen every FXAA sample again, sharpen once into the postfx framebuffer instead.
 								ctx->m_postfx_texture->fillFromBuffer(ctx->m_postfx_framebuffer);
-								ctx->m_fxaa_compute_pipeline->dispatchCompute(App.fxaa.presets.selected, ctx->m_fxaa_work_size, GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+								ctx->bindPipeline(ctx->m_postfx_pipeline);
+								ctx->drawQuad(1);
 							}
 							ctx->bindDefaultFrameBuffer();
 							ctx->setViewport(vp_size, vp_offset);
 							ctx->bindPipeline(ctx->m_postfx_pipeline);
-							ctx->drawQuad(2 + App.gl_caps.compute_shader, App.fxaa.presets.selected);
+							if (App.gl_caps.compute_shader)
+								ctx->drawQuad(3);
+							else
+								ctx->drawQuad(2, preset);
+						} else if (App.sharpen.active) {
+							ctx->bindDefaultFrameBuffer();
+							ctx->setViewport(vp_size, vp_offset);
+							ctx->bindPipeline(ctx->m_postfx_pipeline);
+							ctx->drawQuad(0);
 						}
 					}
 					break;
 				case CommandType::TakeScreenShot:
+					gpu_timer.end();
 					ctx->takeScreenShot();
 					break;
 			}
 		}
 
-		if (cmd->m_vertex_mod_count) {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, cmd->m_vertex_mod_count * sizeof(VertexMod), ctx->m_vertices_mod.data[frame_index].data());
+		if (cmd->m_quad_mod_count) {
+			gpu_timer.begin(GpuStage::Mod);
+			const auto quads = ctx->m_quads_mod.data[frame_index].data();
+			if (App.gl_caps.instanced_mod)
+				glBufferSubData(GL_ARRAY_BUFFER, 0, cmd->m_quad_mod_count * sizeof(QuadMod), quads);
+			else {
+				for (uint32_t i = 0; i < cmd->m_quad_mod_count; i++)
+					quads[i].expand(&ctx->m_vertices_mod[i * 4]);
+				glBufferSubData(GL_ARRAY_BUFFER, 0, cmd->m_quad_mod_count * 4 * sizeof(VertexMod), ctx->m_vertices_mod.data());
+			}
 
 			ctx->bindPipeline(ctx->m_mod_pipeline);
 			if (cmd->m_hd_text_mask.active) {
@@ -520,17 +606,29 @@ void Context::renderThread(void* context)
 				cmd->m_hd_text_mask.active = false;
 			}
 
-			VertexMod::bindingDescription();
-			glDrawElements(GL_TRIANGLES, cmd->m_vertex_mod_count / 4 * 6, GL_UNSIGNED_INT, 0);
+			if (App.gl_caps.instanced_mod) {
+				QuadMod::bindingDescription();
+				glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, cmd->m_quad_mod_count);
+				QuadMod::setDivisor(0);
+			} else {
+				VertexMod::bindingDescription();
+				glDrawElements(GL_TRIANGLES, cmd->m_quad_mod_count * 6, GL_UNSIGNED_INT, 0);
+			}
 		}
 
+		gpu_timer.end();
 		GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 		glFlush();
 		glClientWaitSync(sync, 0, GL_TIMEOUT_IGNORED);
 		glDeleteSync(sync);
 
+		if (render_start)
+			Profiler::Instance().addRender(render_start, __rdtsc());
+
 		ReleaseSemaphore(ctx->m_semaphore_gpu[frame_index], 1, NULL);
+		gpu_timer.begin(GpuStage::Menu);
 		option::Menu::instance().draw();
+		gpu_timer.endFrame();
 		SwapBuffers(App.hdc);
 
 		if (ctx->m_limiter.active) {
@@ -587,14 +685,18 @@ void Context::onResize(glm::uvec2 w_size, glm::uvec2 g_size, uint32_t bpp)
 			bloom_frambuffer_ci.size = m_bloom_tex_size;
 			bloom_frambuffer_ci.attachments = { { TEXTURE_SLOT_BLOOM1, {}, { GL_LINEAR, GL_LINEAR } } };
 			m_bloom_framebuffer = Context::createFrameBuffer(bloom_frambuffer_ci);
-			if (App.gl_caps.compute_shader)
+
+			bloom_frambuffer_ci.attachments = { { TEXTURE_SLOT_BLOOM2, {}, { GL_LINEAR, GL_LINEAR } } };
+			m_bloom_pong_framebuffer = Context::createFrameBuffer(bloom_frambuffer_ci);
+			if (App.gl_caps.compute_shader) {
 				m_bloom_framebuffer->getTexture()->bindImage(IMAGE_UNIT_BLUR);
+				m_bloom_pong_framebuffer->getTexture()->bindImage(IMAGE_UNIT_BLUR2);
+			}
 
-			TextureCreateInfo bloom_texture_ci;
-			bloom_texture_ci.size = m_bloom_tex_size;
-			bloom_texture_ci.slot = TEXTURE_SLOT_BLOOM2;
-			bloom_texture_ci.filter = { GL_LINEAR, GL_LINEAR };
-			m_bloom_texture = Context::createTexture(bloom_texture_ci);
+			for (auto& mip_framebuffer : m_bloom_mip_framebuffers) {
+				bloom_frambuffer_ci.size = glm::max(bloom_frambuffer_ci.size / 2u, glm::uvec2(1, 1));
+				mip_framebuffer = Context::createFrameBuffer(bloom_frambuffer_ci);
+			}
 
 			TextureCreateInfo prefx_texture_ci;
 			prefx_texture_ci.size = game_size;
@@ -624,8 +726,6 @@ void Context::onResize(glm::uvec2 w_size, glm::uvec2 g_size, uint32_t bpp)
 		frambuffer_ci.size = App.viewport.size;
 		frambuffer_ci.attachments = { { TEXTURE_SLOT_POSTFX1, {}, { GL_LINEAR, GL_LINEAR } } };
 		m_postfx_framebuffer = Context::createFrameBuffer(frambuffer_ci);
-		if (App.gl_caps.compute_shader)
-			m_postfx_framebuffer->getTexture()->bindImage(IMAGE_UNIT_FXAA);
 
 		m_fxaa_work_size = { ceil((float)App.viewport.size.x / 16), ceil((float)App.viewport.size.y / 16) };
 
@@ -634,6 +734,8 @@ void Context::onResize(glm::uvec2 w_size, glm::uvec2 g_size, uint32_t bpp)
 		texture_ci.slot = TEXTURE_SLOT_POSTFX2;
 		texture_ci.filter = { GL_LINEAR, GL_LINEAR };
 		m_postfx_texture = Context::createTexture(texture_ci);
+		if (App.gl_caps.compute_shader)
+			m_postfx_texture->bindImage(IMAGE_UNIT_FXAA);
 
 		onShaderChange();
 	}
@@ -726,12 +828,12 @@ void Context::beginFrame()
 	m_vertices.count = m_vertices.start = 0;
 	m_vertices.ptr = m_vertices.data[m_frame_index].data();
 
-	m_vertices_mod.count = 0;
-	m_vertices_mod.ptr = m_vertices_mod.data[m_frame_index].data();
+	m_quads_mod.count = 0;
+	m_quads_mod.ptr = m_quads_mod.data[m_frame_index].data();
 
 	m_delay_push = false;
-	m_vertices_late.count = 0;
-	m_vertices_late.ptr = m_vertices_late.data[0].data();
+	m_quads_late.count = 0;
+	m_quads_late.ptr = m_quads_late.data[0].data();
 
 	m_frame.vertex_count = 0;
 	m_frame.drawcall_count = 0;
@@ -743,6 +845,35 @@ void Context::beginFrame()
 	m_command_buffer[m_frame_index].pushCommand(CommandType::Begin);
 }
 
+int Context::acquireUploadSlice(uint32_t size)
+{
+	if (!m_upload_ptr || size > UPLOAD_SLICE_SIZE)
+		return -1;
+
+	for (uint32_t i = 0; i < m_upload_slice_count; i++) {
+		uint32_t expected = 0;
+		if (m_upload_refs[i].compare_exchange_strong(expected, 1))
+			return i;
+	}
+
+	return -1;
+}
+
+void Context::collectUploadFences()
+{
+	for (auto it = m_upload_fences.begin(); it != m_upload_fences.end();) {
+		const GLenum status = glClientWaitSync(it->second, 0, 0);
+		if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+			it++;
+			continue;
+		}
+
+		glDeleteSync(it->second);
+		releaseUploadSlice(it->first);
+		it = m_upload_fences.erase(it);
+	}
+}
+
 void Context::bindDefaultFrameBuffer()
 {
 	FrameBuffer::unBind();
@@ -758,8 +889,8 @@ void Context::presentFrame()
 
 	modules::HDText::Instance().update();
 
-	if (m_vertices_mod.count) {
-		m_command_buffer[m_frame_index].m_vertex_mod_count = m_vertices_mod.count;
+	if (m_quads_mod.count) {
+		m_command_buffer[m_frame_index].m_quad_mod_count = m_quads_mod.count;
 		m_frame.drawcall_count++;
 	}
 	option::Menu::instance().check();
@@ -767,7 +898,11 @@ void Context::presentFrame()
 	ReleaseSemaphore(m_semaphore_cpu[m_frame_index], 1, NULL);
 	m_frame_index = (m_frame_index + 1) % (App.frame_latency + 1);
 
+	auto& profiler = Profiler::Instance();
+	const uint64_t wait_start = profiler.isActive() ? __rdtsc() : 0;
 	WaitForSingleObject(m_semaphore_gpu[m_frame_index], INFINITE);
+	if (wait_start)
+		profiler.addWait(wait_start, __rdtsc());
 	m_command_buffer[m_frame_index].reset();
 
 	QueryPerformanceCounter(&m_frame.time);
@@ -781,6 +916,8 @@ void Context::presentFrame()
 	m_frame.average_frame_time = std::reduce(iter, m_frame.frame_times.end()) / m_frame.frame_sample_count;
 	m_frame.frame_sample_count += m_frame.frame_sample_count == MAX_FRAMETIME_SAMPLE_COUNT ? 0 : 1;
 	m_frame.frame_count++;
+
+	profiler.endFrame();
 }
 
 void Context::setViewport(glm::ivec2 size, glm::ivec2 offset)
@@ -846,37 +983,61 @@ void Context::drawQuad(int8_t flag_x, int8_t flag_y, int16_t tex_id)
 	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 }
 
+void Context::drawBloomPass(const std::unique_ptr<FrameBuffer>& src, const std::unique_ptr<FrameBuffer>& dst, int8_t flag)
+{
+	const auto texture = src->getTexture();
+	m_prefx_pipeline->setUniform1i("u_BloomSource", texture->getSlot());
+	texture->bind();
+
+	bindFrameBuffer(dst, false);
+	setViewport({ dst->getWidth(), dst->getHeight() });
+	drawQuad(flag);
+}
+
+void Context::dispatchBloomBlur(const std::unique_ptr<FrameBuffer>& src, uint32_t image_unit, int flag, GLbitfield barrier)
+{
+	const auto texture = src->getTexture();
+	m_blur_compute_pipeline->setUniform1i("u_InTexture", texture->getSlot());
+	m_blur_compute_pipeline->setUniform1i("u_OutTexture", image_unit);
+	texture->bind();
+	m_blur_compute_pipeline->dispatchCompute(flag, m_bloom_work_size, barrier);
+}
+
 void Context::pushObject(const std::unique_ptr<Object>& object)
 {
-	const auto vertices = object->getVertices();
+	*allocQuads(1) = object->getQuad();
+}
 
+QuadMod* Context::allocQuads(uint32_t count)
+{
+	QuadMod* ptr;
 	if (m_delay_push) {
-		memcpy(m_vertices_late.ptr, vertices, sizeof(VertexMod) * 4);
-
-		m_vertices_late.ptr += 4;
-		m_vertices_late.count += 4;
+		ptr = m_quads_late.ptr;
+		m_quads_late.ptr += count;
+		m_quads_late.count += count;
 	} else {
-		memcpy(m_vertices_mod.ptr, vertices, sizeof(VertexMod) * 4);
-
-		m_vertices_mod.ptr += 4;
-		m_vertices_mod.count += 4;
+		ptr = m_quads_mod.ptr;
+		m_quads_mod.ptr += count;
+		m_quads_mod.count += count;
 	}
-	m_frame.vertex_count += 4;
+	m_frame.vertex_count += count * 4;
+
+	return ptr;
 }
 
 void Context::appendDelayedObjects()
 {
-	if (m_vertices_late.count == 0)
+	if (m_quads_late.count == 0)
 		return;
 
-	memcpy(m_vertices_mod.ptr, m_vertices_late.data[0].data(), m_vertices_late.count * sizeof(VertexMod));
+	memcpy(m_quads_mod.ptr, m_quads_late.data[0].data(), m_quads_late.count * sizeof(QuadMod));
 
-	m_vertices_mod.count += m_vertices_late.count;
-	m_vertices_mod.ptr += m_vertices_late.count;
+	m_quads_mod.count += m_quads_late.count;
+	m_quads_mod.ptr += m_quads_late.count;
 
 	m_delay_push = false;
-	m_vertices_late.count = 0;
-	m_vertices_late.ptr = m_vertices_late.data[0].data();
+	m_quads_late.count = 0;
+	m_quads_late.ptr = m_quads_late.data[0].data();
 }
 
 void Context::toggleVsync()
@@ -21,6 +21,7 @@
 #include "types.h"
 #include "vertex.h"
 
+#include "asset_loader.h"
 #include "command_buffer.h"
 #include "frame_buffer.h"
 #include "object.h"
@@ -33,8 +34,10 @@ namespace d2gl {
 #define MAX_FRAME_LATENCY 6
 #define MAX_INDICES 6 * 50000
 #define MAX_VERTICES 4 * 50000
-#define MAX_VERTICES_MOD 4 * 20000
+#define MAX_QUADS_MOD 20000
 #define PIXEL_BUFFER_SIZE 12 * 1024 * 1024
+#define UPLOAD_SLICE_SIZE 1024 * 768 * 4
+#define MAX_UPLOAD_SLICES (MAX_FRAME_LATENCY + 3)
 #define MAX_FRAMETIME_SAMPLE_COUNT 120
 
 #define TEXTURE_SLOT_DEFAULT 0
@@ -53,6 +56,9 @@ namespace d2gl {
 
 #define IMAGE_UNIT_BLUR 0
 #define IMAGE_UNIT_FXAA 1
+#define IMAGE_UNIT_BLUR2 2
+
+#define BLOOM_MIP_LEVELS 3
 
 #pragma warning(push)
 #pragma warning(disable : 26495)
@@ -104,6 +110,7 @@ struct LimiterMetrics {
 struct GLCaps {
 	bool compute_shader = false;
 	bool independent_blending = false;
+	bool instanced_mod = false;
 };
 
 class Context {
@@ -121,8 +128,9 @@ class Context {
 
 	bool m_delay_push = false;
 	Vertices<Vertex, MAX_VERTICES, MAX_FRAME_LATENCY> m_vertices;
-	Vertices<VertexMod, MAX_VERTICES_MOD, MAX_FRAME_LATENCY> m_vertices_mod;
-	Vertices<VertexMod, MAX_VERTICES_MOD, 1> m_vertices_late;
+	Vertices<QuadMod, MAX_QUADS_MOD, MAX_FRAME_LATENCY> m_quads_mod;
+	Vertices<QuadMod, MAX_QUADS_MOD, 1> m_quads_late;
+	std::vector<VertexMod> m_vertices_mod;
 	VertexParams m_vertex_params;
 
 	FrameMetrics m_frame;
@@ -145,6 +153,13 @@ class Context {
 	std::unique_ptr<Pipeline> m_mod_pipeline;
 	int m_current_shader = -1;
 
+	// DDraw only
+	GLuint m_upload_buffer = 0;
+	uint8_t* m_upload_ptr = nullptr;
+	uint32_t m_upload_slice_count = 0;
+	std::array<std::atomic<uint32_t>, MAX_UPLOAD_SLICES> m_upload_refs = {};
+	std::vector<std::pair<int, GLsync>> m_upload_fences;
+
 	// Glide only
 	std::unique_ptr<Texture> m_glide_texture;
 	std::map<uint32_t, std::pair<uint32_t, BlendType>> m_blend_types;
@@ -155,8 +170,9 @@ class Context {
 	glm::uvec2 m_bloom_tex_size = { 0, 0 };
 	glm::uvec2 m_bloom_work_size = { 0, 0 };
 	std::unique_ptr<UniformBuffer> m_bloom_ubo;
-	std::unique_ptr<Texture> m_bloom_texture;
 	std::unique_ptr<FrameBuffer> m_bloom_framebuffer;
+	std::unique_ptr<FrameBuffer> m_bloom_pong_framebuffer;
+	std::array<std::unique_ptr<FrameBuffer>, BLOOM_MIP_LEVELS> m_bloom_mip_framebuffers;
 	std::unique_ptr<Pipeline> m_blur_compute_pipeline;
 
 	std::unique_ptr<Texture> m_lut_texture;
@@ -181,6 +197,11 @@ public:
 	inline uint32_t getFrameIndex() { return m_frame_index; }
 	inline CommandBuffer* getCommandBuffer() { return &m_command_buffer[m_frame_index]; }
 
+	int acquireUploadSlice(uint32_t size);
+	inline void retainUploadSlice(int index) { m_upload_refs[index]++; }
+	inline void releaseUploadSlice(int index) { m_upload_refs[index]--; }
+	inline uint8_t* getUploadSlice(int index) { return m_upload_ptr + index * UPLOAD_SLICE_SIZE; }
+
 	void setViewport(glm::ivec2 size, glm::ivec2 offset = { 0, 0 });
 	inline void bindFrameBuffer(const std::unique_ptr<FrameBuffer>& framebuffer, bool clear = true) { framebuffer->bind(clear); }
 	inline void bindPipeline(const std::unique_ptr<Pipeline>& pipeline, uint32_t index = 0) { pipeline->bind(index); }
@@ -191,6 +212,7 @@ public:
 
 	inline void toggleDelayPush(bool delay) { m_delay_push = delay; }
 	void pushObject(const std::unique_ptr<Object>& object);
+	QuadMod* allocQuads(uint32_t count);
 	void appendDelayedObjects();
 
 	inline void setVertexColor(uint32_t color) { m_vertex_params.color = color; }
@@ -217,6 +239,10 @@ public:
 
 private:
 	void resetFileTime();
+	void collectUploadFences();
+
+	void drawBloomPass(const std::unique_ptr<FrameBuffer>& src, const std::unique_ptr<FrameBuffer>& dst, int8_t flag);
+	void dispatchBloomBlur(const std::unique_ptr<FrameBuffer>& src, uint32_t image_unit, int flag, GLbitfield barrier);
 
 	void imguiInit();
 	void imguiDestroy();
@@ -0,0 +1,167 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "gpu_timer.h"
+#include "profiler.h"
+
+namespace d2gl {
+
+namespace {
+
+const char* g_stage_names[] = { "Upload", "Begin", "Draw", "PreFx", "Bloom", "Upscaler", "PostFx", "Mod", "Menu" };
+
+}
+
+void GpuTimer::beginFrame(bool active, uint64_t cpu_start)
+{
+	if (!active) {
+		if (m_active) {
+			for (auto& frame : m_frames) {
+				frame.entries.clear();
+				frame.issued = false;
+			}
+			m_sum = {};
+			m_sum_count = 0;
+			m_stats = {};
+			m_active = false;
+		}
+		return;
+	}
+	m_active = true;
+
+	auto& frame = m_frames[m_frame % GPU_TIMER_FRAMES];
+	if (frame.queries.empty()) {
+		frame.queries.resize(GPU_TIMER_MAX_QUERIES);
+		glGenQueries(GPU_TIMER_MAX_QUERIES, frame.queries.data());
+	}
+
+	if (frame.issued)
+		collect(frame);
+
+	frame.entries.clear();
+	frame.query_count = 0;
+	frame.cpu_start = cpu_start;
+}
+
+void GpuTimer::begin(GpuStage stage)
+{
+	if (!m_active || (m_open && m_stage == stage))
+		return;
+
+	end();
+
+	auto& frame = m_frames[m_frame % GPU_TIMER_FRAMES];
+	if (frame.query_count >= GPU_TIMER_MAX_QUERIES)
+		return;
+
+	const GLuint query = frame.queries[frame.query_count++];
+	frame.entries.push_back({ stage, query });
+	glBeginQuery(GL_TIME_ELAPSED, query);
+	m_open = true;
+	m_stage = stage;
+}
+
+void GpuTimer::end()
+{
+	if (!m_open)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	m_open = false;
+}
+
+void GpuTimer::addQuery(GpuStage stage, GLuint query)
+{
+	if (!m_active)
+		return;
+
+	end();
+	m_frames[m_frame % GPU_TIMER_FRAMES].entries.push_back({ stage, query });
+}
+
+void GpuTimer::endFrame()
+{
+	if (!m_active)
+		return;
+
+	end();
+	auto& frame = m_frames[m_frame % GPU_TIMER_FRAMES];
+	frame.issued = !frame.entries.empty();
+	m_frame++;
+}
+
+void GpuTimer::destroy()
+{
+	for (auto& frame : m_frames) {
+		if (!frame.queries.empty())
+			glDeleteQueries((GLsizei)frame.queries.size(), frame.queries.data());
+		frame.queries.clear();
+		frame.entries.clear();
+		frame.issued = false;
+	}
+	m_active = false;
+	m_open = false;
+}
+
+void GpuTimer::collect(Frame& frame)
+{
+	frame.issued = false;
+
+	// Upscaler queries are deleted when its passes change, such a frame is dropped.
+	for (const auto& entry : frame.entries) {
+		if (!glIsQuery(entry.query))
+			return;
+	}
+
+	GLint available = 0;
+	glGetQueryObjectiv(frame.entries.back().query, GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return;
+
+	// GPU work has no CPU timestamp, stages are laid out back to back from the start of the render frame.
+	auto& profiler = Profiler::Instance();
+	float offset = 0.0f;
+	for (const auto& entry : frame.entries) {
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(entry.query, GL_QUERY_RESULT, &elapsed);
+		const float ms = (float)elapsed / 1000000.0f;
+
+		m_sum[(size_t)entry.stage] += ms;
+		profiler.addGpuSpan(g_stage_names[(size_t)entry.stage], frame.cpu_start, offset, ms);
+		offset += ms;
+	}
+
+	if (++m_sum_count == PROFILER_AVERAGE_FRAMES) {
+		m_stats.total_ms = 0.0f;
+		for (size_t i = 0; i < m_sum.size(); i++) {
+			m_stats.stages[i] = m_sum[i] / m_sum_count;
+			m_stats.total_ms += m_stats.stages[i];
+		}
+		m_sum = {};
+		m_sum_count = 0;
+	}
+}
+
+const char* GpuTimer::getStageName(GpuStage stage)
+{
+	return g_stage_names[(size_t)stage];
+}
+
+}
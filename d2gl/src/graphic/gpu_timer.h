@@ -0,0 +1,97 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+namespace d2gl {
+
+#define GPU_TIMER_FRAMES 2
+#define GPU_TIMER_MAX_QUERIES 64
+
+enum class GpuStage : uint8_t {
+	Upload,
+	Begin,
+	Draw,
+	PreFx,
+	Bloom,
+	Upscaler,
+	PostFx,
+	Mod,
+	Menu,
+	Count,
+};
+
+// Per frame averages over the last PROFILER_AVERAGE_FRAMES frames.
+struct GpuStats {
+	float total_ms = 0.0f;
+	std::array<float, (size_t)GpuStage::Count> stages = {};
+};
+
+// GL_TIME_ELAPSED queries around the render thread stages. Queries can not nest, so beginning a stage ends the
+// previous one. The upscaler adds its own per pass queries with addQuery, its ring outlives ours so they are still valid.
+class GpuTimer {
+	struct Entry {
+		GpuStage stage;
+		GLuint query;
+	};
+
+	struct Frame {
+		std::vector<GLuint> queries;
+		std::vector<Entry> entries;
+		uint32_t query_count = 0;
+		uint64_t cpu_start = 0;
+		bool issued = false;
+	};
+
+	std::array<Frame, GPU_TIMER_FRAMES> m_frames;
+	uint32_t m_frame = 0;
+	bool m_active = false;
+	bool m_open = false;
+	GpuStage m_stage = GpuStage::Count;
+
+	std::array<float, (size_t)GpuStage::Count> m_sum = {};
+	uint32_t m_sum_count = 0;
+	GpuStats m_stats;
+
+	GpuTimer() = default;
+	~GpuTimer() = default;
+
+	void collect(Frame& frame);
+
+public:
+	static GpuTimer& Instance()
+	{
+		static GpuTimer instance;
+		return instance;
+	}
+
+	void beginFrame(bool active, uint64_t cpu_start);
+	void begin(GpuStage stage);
+	void end();
+	void addQuery(GpuStage stage, GLuint query);
+	void endFrame();
+	void destroy();
+
+	inline bool isActive() { return m_active; }
+	inline const GpuStats& getStats() { return m_stats; }
+
+	static const char* getStageName(GpuStage stage);
+};
+
+}
@@ -24,11 +24,10 @@ namespace d2gl {
 Object::Object(glm::vec2 position, glm::vec2 size)
 	: m_position(position), m_size(size)
 {
-	for (size_t i = 0; i < 4; i++) {
-		m_vertices[i].color1 = 0xFFFFFFFF;
-		m_vertices[i].color2 = 0xFFFFFFFF;
-		m_vertices[i].tex_ids = { 0, 0 };
-	}
+	m_quad.color1 = 0xFFFFFFFF;
+	m_quad.color2 = 0xFFFFFFFF;
+	m_quad.tex_ids = { 0, 0 };
+	m_quad.extra = { 0, 0 };
 	setPosition(position);
 	setTexCoord({ 0.0f, 0.0f, 1.0f, 1.0f });
 	setFlags();
@@ -37,66 +36,44 @@ Object::Object(glm::vec2 position, glm::vec2 size)
 void Object::setPosition(glm::vec2 position)
 {
 	m_position = position;
-	m_vertices[0].position = { glm::detail::toFloat16(m_position.x), glm::detail::toFloat16(m_position.y) };
-	m_vertices[1].position = { glm::detail::toFloat16(m_position.x + m_size.x), glm::detail::toFloat16(m_position.y) };
-	m_vertices[2].position = { glm::detail::toFloat16(m_position.x + m_size.x), glm::detail::toFloat16(m_position.y + m_size.y) };
-	m_vertices[3].position = { glm::detail::toFloat16(m_position.x), glm::detail::toFloat16(m_position.y + m_size.y) };
+	m_quad.rect.x = glm::detail::toFloat16(m_position.x);
+	m_quad.rect.y = glm::detail::toFloat16(m_position.y);
+	setSize(m_size);
 }
 
 void Object::setSize(glm::vec2 size)
 {
 	m_size = size;
-	m_vertices[1].position.x = glm::detail::toFloat16(m_position.x + m_size.x);
-	m_vertices[2].position = { glm::detail::toFloat16(m_position.x + m_size.x), glm::detail::toFloat16(m_position.y + m_size.y) };
-	m_vertices[3].position.y = glm::detail::toFloat16(m_position.y + m_size.y);
+	m_quad.rect.z = glm::detail::toFloat16(m_position.x + m_size.x);
+	m_quad.rect.w = glm::detail::toFloat16(m_position.y + m_size.y);
 }
 
 void Object::setTexCoord(glm::vec4 tex_coord)
 {
-	m_vertices[0].tex_coord = { tex_coord.x, tex_coord.w };
-	m_vertices[1].tex_coord = { tex_coord.z, tex_coord.w };
-	m_vertices[2].tex_coord = { tex_coord.z, tex_coord.y };
-	m_vertices[3].tex_coord = { tex_coord.x, tex_coord.y };
+	m_quad.tex_rect = QuadMod::toTexRect(tex_coord);
 }
 
 void Object::setTexIds(glm::vec<2, int16_t> tex_ids)
 {
-	m_vertices[0].tex_ids = tex_ids;
-	m_vertices[1].tex_ids = tex_ids;
-	m_vertices[2].tex_ids = tex_ids;
-	m_vertices[3].tex_ids = tex_ids;
+	m_quad.tex_ids = tex_ids;
 }
 
 void Object::setColor(uint32_t color, int num)
 {
-	if (num == 1) {
-		m_vertices[0].color1 = color;
-		m_vertices[1].color1 = color;
-		m_vertices[2].color1 = color;
-		m_vertices[3].color1 = color;
-	} else {
-		m_vertices[0].color2 = color;
-		m_vertices[1].color2 = color;
-		m_vertices[2].color2 = color;
-		m_vertices[3].color2 = color;
-	}
+	if (num == 1)
+		m_quad.color1 = color;
+	else
+		m_quad.color2 = color;
 }
 
 void Object::setFlags(uint8_t x, uint8_t y, uint8_t z, uint8_t w)
 {
-	const glm::vec<4, uint8_t> flags = { x, y, z, w };
-	m_vertices[0].flags = flags;
-	m_vertices[1].flags = flags;
-	m_vertices[2].flags = flags;
-	m_vertices[3].flags = flags;
+	m_quad.flags = { x, y, z, w };
 }
 
 void Object::setExtra(glm::vec2 extra)
 {
-	m_vertices[0].extra = { glm::detail::toFloat16(extra.x), glm::detail::toFloat16(extra.y) };
-	m_vertices[1].extra = m_vertices[0].extra;
-	m_vertices[2].extra = m_vertices[0].extra;
-	m_vertices[3].extra = m_vertices[0].extra;
+	m_quad.extra = { glm::detail::toFloat16(extra.x), glm::detail::toFloat16(extra.y) };
 }
 
 }
\ No newline at end of file
@@ -24,7 +24,7 @@
 namespace d2gl {
 
 class Object {
-	VertexMod m_vertices[4];
+	QuadMod m_quad;
 	glm::vec2 m_position;
 	glm::vec2 m_size;
 
@@ -40,7 +40,7 @@ public:
 	void setFlags(uint8_t x = 0, uint8_t y = 0, uint8_t z = 0, uint8_t w = 0);
 	void setExtra(glm::vec2 extra);
 
-	inline const VertexMod* getVertices() { return m_vertices; };
+	inline const QuadMod& getQuad() { return m_quad; };
 };
 
 }
\ No newline at end of file
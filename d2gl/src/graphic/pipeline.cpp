@@ -266,6 +266,10 @@ const char* g_shader_mod = {
 #include "shaders/mod.glsl.h"
 };
 
+// mod.glsl.h is include-once, so the instanced variant is prefixed at startup.
+const std::string g_shader_mod_instanced_src = std::string("#define INSTANCED 1\n") + g_shader_mod;
+const char* g_shader_mod_instanced = g_shader_mod_instanced_src.c_str();
+
 const std::map<uint32_t, std::pair<uint32_t, BlendType>> g_blend_types = {
 	{ 0, { 0, BlendType::One_Zero } },
 	{ 2, { 1, BlendType::Zero_SColor } },
@@ -1,8 +1,13 @@
 #pragma once
 
 "#ifdef VERTEX\n"
+"\n#ifdef INSTANCED\n"
+"layout(location=0) in vec4 Rect;"
+"layout(location=1) in vec4 TexRect;"
+"\n#else\n"
 "layout(location=0) in vec2 Position;"
 "layout(location=1) in vec2 TexCoord;"
+"\n#endif\n"
 "layout(location=2) in vec4 Color1;"
 "layout(location=3) in vec4 Color2;"
 "layout(location=4) in ivec2 TexIds;"
@@ -17,6 +22,11 @@
 "out vec2 v_Extra;"
 "void main()"
 "{"
+"\n#ifdef INSTANCED\n"
+  "vec2 corner=vec2(gl_VertexID&1,gl_VertexID>>1);"
+  "vec2 Position=mix(Rect.xy,Rect.zw,corner);"
+  "vec2 TexCoord=mix(TexRect.xy,TexRect.zw,corner)/16384.;"
+"\n#endif\n"
   "v_Position=u_MVP*vec4(Position,0,1);"
   "gl_Position=v_Position;"
   "v_TexCoord=TexCoord;"
@@ -38,7 +38,44 @@
 	This is similar to using Unsharp Mask in Photoshop.
 */
 
+#ifndef VERTEX
+
+layout(std140) uniform ubo_Metrics {
+	float u_SharpStrength;
+	float u_SharpClamp;
+	float u_Radius;
+	float pad1;
+	vec2 u_RelSize;
+};
+
 #define P(x, y) texture(x, y).rgb
+#define CoefLuma vec3(0.2126, 0.7152, 0.0722)
+
+vec3 LumaSharpen(sampler2D tex, vec2 tc)
+{
+	vec3 rgb = P(tex, tc);
+	vec3 p1 = P(tex, tc + u_RelSize * u_Radius);
+	vec3 p2 = P(tex, tc - u_RelSize * u_Radius);
+	vec3 color = (p1 + p2) / 2.0;
+
+	vec3 sharp = rgb - color;
+	vec3 sharp_str = (CoefLuma * u_SharpStrength) * 1.5;
+	vec4 sharp_clamp = vec4(sharp_str * (0.5 / u_SharpClamp), 0.5);
+
+	float sharp_luma = (u_SharpClamp * 2.0) * clamp(dot(vec4(sharp, 1.0), sharp_clamp), 0.0, 1.0) - u_SharpClamp;
+
+	return clamp(rgb + sharp_luma, 0.0, 1.0);
+}
+
+vec3 FxaaSample(sampler2D tex, vec2 pos, bool sharpen)
+{
+	return sharpen ? LumaSharpen(tex, pos) : P(tex, pos);
+}
+
+#ifdef COMPUTE
+// 16x16 work group plus one texel border, filled once per group.
+shared vec3 s_Tile[18][18];
+#endif
 
 float FxaaLuma(vec3 rgb)
 {
@@ -50,13 +87,18 @@ vec3 FxaaLerp3(vec3 a, vec3 b, float amountOfA)
     return (vec3(-amountOfA) * b) + ((a * vec3(amountOfA)) + b);
 }
 
-vec3 FxaaTexOff(sampler2D tex, vec2 pos, ivec2 off, vec2 rcpFrame) {
+vec3 FxaaTexOff(sampler2D tex, vec2 pos, ivec2 off, vec2 rcpFrame, bool sharpen) {
+#ifdef COMPUTE
+    ivec2 tc = ivec2(gl_LocalInvocationID.xy) + off + 1;
+    return s_Tile[tc.y][tc.x];
+#else
     float x = pos.x + float(off.x) * rcpFrame.x;
     float y = pos.y + float(off.y) * rcpFrame.y;
-    return P(tex, vec2(x, y));
+    return FxaaSample(tex, vec2(x, y), sharpen);
+#endif
 }
 
-vec3 FxaaPass(sampler2D tex, vec2 pos, vec2 rcpFrame, uint preset)
+vec3 FxaaPass(sampler2D tex, vec2 pos, vec2 rcpFrame, uint preset, bool sharpen)
 {
     float FXAA_EDGE_THRESHOLD = (1.0/8.0);
     float FXAA_EDGE_THRESHOLD_MIN = (1.0/16.0);
@@ -80,11 +122,11 @@ vec3 FxaaPass(sampler2D tex, vec2 pos, vec2 rcpFrame, uint preset)
         FXAA_SEARCH_STEPS = 32;
     }
 
-    vec3 rgbN = FxaaTexOff(tex, pos.xy, ivec2( 0,-1), rcpFrame);
-    vec3 rgbW = FxaaTexOff(tex, pos.xy, ivec2(-1, 0), rcpFrame);
-    vec3 rgbM = FxaaTexOff(tex, pos.xy, ivec2( 0, 0), rcpFrame);
-    vec3 rgbE = FxaaTexOff(tex, pos.xy, ivec2( 1, 0), rcpFrame);
-    vec3 rgbS = FxaaTexOff(tex, pos.xy, ivec2( 0, 1), rcpFrame);
+    vec3 rgbN = FxaaTexOff(tex, pos.xy, ivec2( 0,-1), rcpFrame, sharpen);
+    vec3 rgbW = FxaaTexOff(tex, pos.xy, ivec2(-1, 0), rcpFrame, sharpen);
+    vec3 rgbM = FxaaTexOff(tex, pos.xy, ivec2( 0, 0), rcpFrame, sharpen);
+    vec3 rgbE = FxaaTexOff(tex, pos.xy, ivec2( 1, 0), rcpFrame, sharpen);
+    vec3 rgbS = FxaaTexOff(tex, pos.xy, ivec2( 0, 1), rcpFrame, sharpen);
     
     float lumaN = FxaaLuma(rgbN);
     float lumaW = FxaaLuma(rgbW);
@@ -105,10 +147,10 @@ vec3 FxaaPass(sampler2D tex, vec2 pos, vec2 rcpFrame, uint preset)
     float blendL = max(0.0, (rangeL / range) - FXAA_SUBPIX_TRIM) * (1.0/(1.0 - FXAA_SUBPIX_TRIM)); 
     blendL = min(FXAA_SUBPIX_CAP, blendL);
     
-    vec3 rgbNW = FxaaTexOff(tex, pos.xy, ivec2(-1,-1), rcpFrame);
-    vec3 rgbNE = FxaaTexOff(tex, pos.xy, ivec2( 1,-1), rcpFrame);
-    vec3 rgbSW = FxaaTexOff(tex, pos.xy, ivec2(-1, 1), rcpFrame);
-    vec3 rgbSE = FxaaTexOff(tex, pos.xy, ivec2( 1, 1), rcpFrame);
+    vec3 rgbNW = FxaaTexOff(tex, pos.xy, ivec2(-1,-1), rcpFrame, sharpen);
+    vec3 rgbNE = FxaaTexOff(tex, pos.xy, ivec2( 1,-1), rcpFrame, sharpen);
+    vec3 rgbSW = FxaaTexOff(tex, pos.xy, ivec2(-1, 1), rcpFrame, sharpen);
+    vec3 rgbSE = FxaaTexOff(tex, pos.xy, ivec2( 1, 1), rcpFrame, sharpen);
     rgbL += (rgbNW + rgbNE + rgbSW + rgbSE);
     rgbL *= vec3(1.0/9.0);
     
@@ -163,9 +205,9 @@ vec3 FxaaPass(sampler2D tex, vec2 pos, vec2 rcpFrame, uint preset)
     
     for(int i = 0; i < FXAA_SEARCH_STEPS; i++) {
         if(!doneN)
-            lumaEndN = FxaaLuma(P(tex, posN.xy));
+            lumaEndN = FxaaLuma(FxaaSample(tex, posN.xy, sharpen));
         if(!doneP)
-            lumaEndP = FxaaLuma(P(tex, posP.xy));
+            lumaEndP = FxaaLuma(FxaaSample(tex, posP.xy, sharpen));
         
         doneN = doneN || (abs(lumaEndN - lumaN) >= gradientN);
         doneP = doneP || (abs(lumaEndP - lumaN) >= gradientN);
@@ -189,10 +231,12 @@ vec3 FxaaPass(sampler2D tex, vec2 pos, vec2 rcpFrame, uint preset)
     float spanLength = (dstP + dstN);
     dstN = directionN ? dstN : dstP;
     float subPixelOffset = (0.5 + (dstN * (-1.0/spanLength))) * lengthSign;
-    vec3 rgbF = P(tex, vec2(pos.x + (horzSpan ? 0.0 : subPixelOffset), pos.y + (horzSpan ? subPixelOffset : 0.0)));
+    vec3 rgbF = FxaaSample(tex, vec2(pos.x + (horzSpan ? 0.0 : subPixelOffset), pos.y + (horzSpan ? subPixelOffset : 0.0)), sharpen);
     return FxaaLerp3(rgbL, rgbF, blendL); 
 }
 
+#endif
+
 #ifdef VERTEX
 
 layout(location = 0) in vec2 Position;
@@ -216,45 +260,19 @@ void main()
 
 layout(location = 0) out vec4 FragColor;
 
-layout(std140) uniform ubo_Metrics {
-	float u_SharpStrength;
-	float u_SharpClamp;
-	float u_Radius;
-	float pad1;
-	vec2 u_RelSize;
-};
-
 uniform sampler2D u_Texture0;
 uniform sampler2D u_Texture1;
 
 in vec2 v_TexCoord;
 flat in uvec4 v_Flags;
 
-#define CoefLuma vec3(0.2126, 0.7152, 0.0722)
-
-vec3 LumaSharpen(sampler2D tex, vec2 tc)
-{
-	vec3 rgb = P(tex, tc);
-	vec3 p1 = P(tex, tc + u_RelSize * u_Radius);
-	vec3 p2 = P(tex, tc - u_RelSize * u_Radius);
-	vec3 color = (p1 + p2) / 2.0;
-
-	vec3 sharp = rgb - color;
-	vec3 sharp_str = (CoefLuma * u_SharpStrength) * 1.5;
-	vec4 sharp_clamp = vec4(sharp_str * (0.5 / u_SharpClamp), 0.5);
-
-	float sharp_luma = (u_SharpClamp * 2.0) * clamp(dot(vec4(sharp, 1.0), sharp_clamp), 0.0, 1.0) - u_SharpClamp;
-
-	return clamp(rgb + sharp_luma, 0.0, 1.0);
-}
-
 void main()
 {
 	switch(v_Flags.x) {
 		case 0u: FragColor = vec4(LumaSharpen(u_Texture0, v_TexCoord), 1.0); break;
 		case 1u: FragColor = vec4(LumaSharpen(u_Texture1, v_TexCoord), 1.0); break;
-		case 2u: FragColor = vec4(FxaaPass(u_Texture0, v_TexCoord, u_RelSize, v_Flags.y), 1.0); break;
-		case 3u: FragColor = vec4(P(u_Texture0, v_TexCoord), 1.0); break;
+		case 2u: FragColor = vec4(FxaaPass(u_Texture0, v_TexCoord, u_RelSize, v_Flags.y, false), 1.0); break;
+		case 3u: FragColor = vec4(P(u_Texture1, v_TexCoord), 1.0); break;
 	}
 }
 
@@ -272,9 +290,18 @@ void main()
 {
 	ivec2 position = ivec2(gl_GlobalInvocationID.xy);
 	vec2 tex_size = vec2(textureSize(u_InTexture, 0));
-	vec2 v_TexCoord = (vec2(position) + vec2(0.5)) / tex_size;
+	vec2 rcp_frame = vec2(1.0) / tex_size;
+	bool sharpen = (u_Flag & 4u) != 0u;
+
+	ivec2 origin = ivec2(gl_WorkGroupID.xy) * 16 - 1;
+	for (uint i = gl_LocalInvocationIndex; i < 18u * 18u; i += 256u) {
+		ivec2 tc = ivec2(int(i % 18u), int(i / 18u));
+		s_Tile[tc.y][tc.x] = FxaaSample(u_InTexture, (vec2(origin + tc) + vec2(0.5)) * rcp_frame, sharpen);
+	}
+	barrier();
 
-	vec3 color = FxaaPass(u_InTexture, v_TexCoord, vec2(1.0) / tex_size, u_Flag);
+	vec2 v_TexCoord = (vec2(position) + vec2(0.5)) * rcp_frame;
+	vec3 color = FxaaPass(u_InTexture, v_TexCoord, rcp_frame, u_Flag & 3u, sharpen);
 	imageStore(u_OutTexture, position, vec4(color, 1.0));
 }
 
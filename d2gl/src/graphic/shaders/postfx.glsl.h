@@ -1,6 +1,25 @@
 #pragma once
 
-"#define P(x,y)texture(x,y).rgb\n"
+"#ifndef VERTEX\n"
+"layout(std140) uniform ubo_Metrics{float u_SharpStrength;float u_SharpClamp;float u_Radius;float pad1;vec2 u_RelSize;};"
+"\n#define P(x,y)texture(x,y).rgb\n"
+"\n#define CoefLuma vec3(0.2126,0.7152,0.0722)\n"
+"vec3 u(sampler2D v,vec2 y)"
+"{"
+  "vec3 u=P(v,y),i=P(v,y+u_RelSize*u_Radius),n=P(v,y-u_RelSize*u_Radius),l=CoefLuma*u_SharpStrength*1.5;"
+  "vec4 m=vec4(l*(.5/u_SharpClamp),.5);"
+  "float x=u_SharpClamp*2.*clamp(dot(vec4(u-(i+n)/2.,1),m),0.,1.)-u_SharpClamp;"
+  "return clamp(u+x,0.,1.);"
+"}"
+"vec3 u(sampler2D v,vec2 y,bool i)"
+"{"
+  "return i?"
+    "u(v,y):"
+    "P(v,y);"
+"}"
+"\n#ifdef COMPUTE\n"
+"shared vec3 ad[18][18];"
+"\n#endif\n"
 "float u(vec3 u)"
 "{"
   "return u.y*(.587/.299)+u.x;"
@@ -9,12 +28,17 @@
 "{"
   "return vec3(-v)*y+(u*vec3(v)+y);"
 "}"
-"vec3 u(sampler2D u,vec2 v,ivec2 y,vec2 i)"
+"vec3 u(sampler2D x,vec2 v,ivec2 y,vec2 i,bool s)"
 "{"
-  "float x=v.x+float(y.x)*i.x,n=v.y+float(y.y)*i.y;"
-  "return P(u,vec2(x,n));"
+"\n#ifdef COMPUTE\n"
+  "ivec2 n=ivec2(gl_LocalInvocationID.xy)+y+1;"
+  "return ad[n.y][n.x];"
+"\n#else\n"
+  "float n=v.x+float(y.x)*i.x,m=v.y+float(y.y)*i.y;"
+  "return u(x,vec2(n,m),s);"
+"\n#endif\n"
 "}"
-"vec3 v(sampler2D v,vec2 i,vec2 y,uint s)"
+"vec3 v(sampler2D v,vec2 i,vec2 y,uint s,bool ac)"
 "{"
   "float n=.125,x=.0625,m=.25,l=.75,d=.25;"
   "int k=16;"
@@ -23,14 +47,14 @@
   "else "
      "if(s==3u)"
       "n=.125,x=1./24.,m=.25,l=.75,d=.25,k=32;"
-  "vec3 a=u(v,i.xy,ivec2(0,-1),y),r=u(v,i.xy,ivec2(-1,0),y),e=u(v,i.xy,ivec2(0,0),y),f=u(v,i.xy,ivec2(1,0),y),g=u(v,i.xy,ivec2(0,1),y);"
+  "vec3 a=u(v,i.xy,ivec2(0,-1),y,ac),r=u(v,i.xy,ivec2(-1,0),y,ac),e=u(v,i.xy,ivec2(0,0),y,ac),f=u(v,i.xy,ivec2(1,0),y,ac),g=u(v,i.xy,ivec2(0,1),y,ac);"
   "float b=u(a),C=u(r),c=u(e),p=u(f),F=u(g),h=min(c,min(min(b,C),min(F,p))),T=max(c,max(max(b,C),max(F,p))),t=T-h;"
   "if(t<max(x,T*n))"
     "return e;"
   "vec3 o=a+r+e+f+g;"
   "float V=(b+C+p+F)*.25,A=abs(V-c),w=max(0.,A/t-d)*(1./(1.-d));"
   "w=min(l,w);"
-  "vec3 B=u(v,i.xy,ivec2(-1,-1),y),D=u(v,i.xy,ivec2(1,-1),y),E=u(v,i.xy,ivec2(-1,1),y),G=u(v,i.xy,ivec2(1,1),y);"
+  "vec3 B=u(v,i.xy,ivec2(-1,-1),y,ac),D=u(v,i.xy,ivec2(1,-1),y,ac),E=u(v,i.xy,ivec2(-1,1),y,ac),G=u(v,i.xy,ivec2(1,1),y,ac);"
   "o+=B+D+E+G;"
   "o*=vec3(1./9.);"
   "float H=u(B),I=u(D),J=u(E),K=u(G),L=abs(.25*H+-.5*b+.25*I)+abs(.5*C+-1.*c+.5*p)+abs(.25*J+-.5*F+.25*K),M=abs(.25*H+-.5*C+.25*J)+abs(.5*b+-1.*c+.5*F)+abs(.25*I+-.5*p+.25*K);"
@@ -63,9 +87,9 @@
   "for(int q=0;q<k;q++)"
     "{"
       "if(!Z)"
-        "X=u(P(v,S.xy));"
+        "X=u(u(v,S.xy,ac));"
       "if(!j)"
-        "Y=u(P(v,U.xy));"
+        "Y=u(u(v,U.xy,ac));"
       "Z=Z||abs(X-b)>=Q;"
       "j=j||abs(Y-b)>=Q;"
       "if(Z&&j)"
@@ -91,13 +115,14 @@
     "q:"
     "z;"
   "float ag=(.5+q*(-1./ay))*O;"
-  "vec3 ab=P(v,vec2(i.x+(N?"
+  "vec3 ab=u(v,vec2(i.x+(N?"
     "0.:"
     "ag),i.y+(N?"
     "ag:"
-    "0.)));"
+    "0.)),ac);"
   "return u(o,ab,w);"
 "}"
+"\n#endif\n"
 "\n#ifdef VERTEX\n"
 "layout(location=0) in vec2 Position;"
 "layout(location=1) in vec2 TexCoord;"
@@ -112,18 +137,10 @@
   "v_Flags=Flags;"
 "}"
 "\n#elif FRAGMENT\n"
-"layout(location=0) out vec4 FragColor;layout(std140) uniform ubo_Metrics{float u_SharpStrength;float u_SharpClamp;float u_Radius;float pad1;vec2 u_RelSize;};"
+"layout(location=0) out vec4 FragColor;"
 "uniform sampler2D u_Texture0,u_Texture1;"
 "in vec2 v_TexCoord;"
 "flat in uvec4 v_Flags;"
-"\n#define CoefLuma vec3(0.2126,0.7152,0.0722)\n"
-"vec3 u(sampler2D v,vec2 y)"
-"{"
-  "vec3 u=P(v,y),i=P(v,y+u_RelSize*u_Radius),n=P(v,y-u_RelSize*u_Radius),l=CoefLuma*u_SharpStrength*1.5;"
-  "vec4 m=vec4(l*(.5/u_SharpClamp),.5);"
-  "float x=u_SharpClamp*2.*clamp(dot(vec4(u-(i+n)/2.,1),m),0.,1.)-u_SharpClamp;"
-  "return clamp(u+x,0.,1.);"
-"}"
 "void main()"
 "{"
   "switch(v_Flags.x){"
@@ -134,10 +151,10 @@
       "FragColor=vec4(u(u_Texture1,v_TexCoord),1);"
       "break;"
     "case 2u:"
-      "FragColor=vec4(v(u_Texture0,v_TexCoord,u_RelSize,v_Flags.y),1);"
+      "FragColor=vec4(v(u_Texture0,v_TexCoord,u_RelSize,v_Flags.y,false),1);"
       "break;"
     "case 3u:"
-      "FragColor=vec4(P(u_Texture0,v_TexCoord),1);"
+      "FragColor=vec4(P(u_Texture1,v_TexCoord),1);"
       "break;"
   "}"
 "}"
@@ -149,8 +166,17 @@
 "void main()"
 "{"
   "ivec2 y=ivec2(gl_GlobalInvocationID.xy);"
-  "vec2 u=vec2(textureSize(u_InTexture,0)),i=(vec2(y)+vec2(.5))/u;"
-  "vec3 x=v(u_InTexture,i,vec2(1)/u,u_Flag);"
+  "vec2 a=vec2(textureSize(u_InTexture,0)),n=vec2(1)/a;"
+  "bool s=(u_Flag&4u)!=0u;"
+  "ivec2 m=ivec2(gl_WorkGroupID.xy)*16-1;"
+  "for(uint l=gl_LocalInvocationIndex;l<324u;l+=256u)"
+    "{"
+      "ivec2 d=ivec2(int(l%18u),int(l/18u));"
+      "ad[d.y][d.x]=u(u_InTexture,(vec2(m+d)+vec2(.5))*n,s);"
+    "}"
+  "barrier();"
+  "vec2 i=(vec2(y)+vec2(.5))*n;"
+  "vec3 x=v(u_InTexture,i,n,u_Flag&3u,s);"
   "imageStore(u_OutTexture,y,vec4(x,1));"
 "}"
 "\n#endif"
\ No newline at end of file
@@ -52,7 +52,7 @@ layout(std140) uniform ubo_Metrics {
 
 uniform sampler2D u_Texture;
 uniform sampler2D u_BloomTexture1;
-uniform sampler2D u_BloomTexture2;
+uniform sampler2D u_BloomSource;
 uniform sampler2DArray u_LUTTexture;
 
 in vec2 v_TexCoord;
@@ -104,6 +104,36 @@ vec4 BlurPass13(sampler2D tex, int dir)
 	return res;
 }
 
+// Dual filter (Kawase) down/up sampling, offsets in source texels.
+vec4 DualDown(sampler2D tex)
+{
+	vec2 hp = 1.0 / vec2(textureSize(tex, 0));
+
+	vec4 res = texture(tex, v_TexCoord) * 4.0;
+	res += texture(tex, v_TexCoord - hp);
+	res += texture(tex, v_TexCoord + hp);
+	res += texture(tex, v_TexCoord + vec2(hp.x, -hp.y));
+	res += texture(tex, v_TexCoord - vec2(hp.x, -hp.y));
+
+	return res / 8.0;
+}
+
+vec4 DualUp(sampler2D tex)
+{
+	vec2 hp = 0.5 / vec2(textureSize(tex, 0));
+
+	vec4 res = texture(tex, v_TexCoord + vec2(-hp.x * 2.0, 0.0));
+	res += texture(tex, v_TexCoord + vec2(-hp.x, hp.y)) * 2.0;
+	res += texture(tex, v_TexCoord + vec2(0.0, hp.y * 2.0));
+	res += texture(tex, v_TexCoord + vec2(hp.x, hp.y)) * 2.0;
+	res += texture(tex, v_TexCoord + vec2(hp.x * 2.0, 0.0));
+	res += texture(tex, v_TexCoord + vec2(hp.x, -hp.y)) * 2.0;
+	res += texture(tex, v_TexCoord + vec2(0.0, -hp.y * 2.0));
+	res += texture(tex, v_TexCoord + vec2(-hp.x, -hp.y)) * 2.0;
+
+	return res / 12.0;
+}
+
 vec4 mixfix(vec4 a, vec4 b, float c)
 {
 	return (a.z < 1.0) ? mix(a, b, c) : a;
@@ -129,8 +159,10 @@ void main()
 {
 	switch(v_Flags.x) {
 		case 0u: FragColor = BloomOut(); break;
-		case 1u: FragColor = BlurPass13(u_BloomTexture2, 0); break;
-		case 2u: FragColor = BlurPass13(u_BloomTexture2, 1); break;
+		case 1u: FragColor = BlurPass13(u_BloomSource, 0); break;
+		case 2u: FragColor = BlurPass13(u_BloomSource, 1); break;
+		case 5u: FragColor = DualDown(u_BloomSource); break;
+		case 6u: FragColor = DualUp(u_BloomSource); break;
 		case 3u: case 4u:
 			vec3 out_color = texture(u_Texture, v_TexCoord).rgb;
 			if (v_Flags.x == 4u) {
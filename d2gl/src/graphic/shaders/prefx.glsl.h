@@ -20,7 +20,7 @@
 "layout(location=0) out vec4 FragColor;"
 "layout(location=1) out vec4 FragColorMap;"
 "layout(location=2) out vec4 FragColorMask;layout(std140) uniform ubo_Metrics{float u_BloomExp;float u_BloomGamma;vec2 u_RelSize;};"
-"uniform sampler2D u_Texture,u_BloomTexture1,u_BloomTexture2;"
+"uniform sampler2D u_Texture,u_BloomTexture1,u_BloomSource;"
 "uniform sampler2DArray u_LUTTexture;"
 "in vec2 v_TexCoord;"
 "flat in ivec2 v_TexIds;"
@@ -59,6 +59,29 @@
   "i+=texture(v,F[12])*.000244140625;"
   "return i;"
 "}"
+"vec4 D(sampler2D v)"
+"{"
+  "vec2 u=1./vec2(textureSize(v,0));"
+  "vec4 i=texture(v,v_TexCoord)*4.;"
+  "i+=texture(v,v_TexCoord-u);"
+  "i+=texture(v,v_TexCoord+u);"
+  "i+=texture(v,v_TexCoord+vec2(u.x,-u.y));"
+  "i+=texture(v,v_TexCoord-vec2(u.x,-u.y));"
+  "return i/8.;"
+"}"
+"vec4 U(sampler2D v)"
+"{"
+  "vec2 u=.5/vec2(textureSize(v,0));"
+  "vec4 i=texture(v,v_TexCoord+vec2(-u.x*2.,0));"
+  "i+=texture(v,v_TexCoord+vec2(-u.x,u.y))*2.;"
+  "i+=texture(v,v_TexCoord+vec2(0,u.y*2.));"
+  "i+=texture(v,v_TexCoord+vec2(u.x,u.y))*2.;"
+  "i+=texture(v,v_TexCoord+vec2(u.x*2.,0));"
+  "i+=texture(v,v_TexCoord+vec2(u.x,-u.y))*2.;"
+  "i+=texture(v,v_TexCoord+vec2(0,-u.y*2.));"
+  "i+=texture(v,v_TexCoord+vec2(-u.x,-u.y))*2.;"
+  "return i/12.;"
+"}"
 "vec4 t(vec4 v,vec4 u,float F)"
 "{"
   "return v.z<1.?"
@@ -79,10 +102,16 @@
       "FragColor=t();"
       "break;"
     "case 1u:"
-      "FragColor=t(u_BloomTexture2,0);"
+      "FragColor=t(u_BloomSource,0);"
       "break;"
     "case 2u:"
-      "FragColor=t(u_BloomTexture2,1);"
+      "FragColor=t(u_BloomSource,1);"
+      "break;"
+    "case 5u:"
+      "FragColor=D(u_BloomSource);"
+      "break;"
+    "case 6u:"
+      "FragColor=U(u_BloomSource);"
       "break;"
     "case 3u:"
     "case 4u:"
@@ -97,27 +97,40 @@ void Texture::fillFromBuffer(const std::unique_ptr<FrameBuffer>& fbo, uint32_t i
 	glCopyTexSubImage2D(m_target, 0, (m_width - width) / 2, (m_height - height) / 2, 0, 0, width, height);
 }
 
+uint32_t Texture::reserveLayers(uint32_t count)
+{
+	const uint32_t start_layer = m_next_layer;
+	if (m_target != GL_TEXTURE_2D)
+		m_next_layer += count;
+
+	return start_layer;
+}
+
 TextureData Texture::fillImage(ImageData image, uint32_t div_x, uint32_t div_y)
 {
-	TextureData texture_data = { m_next_layer };
+	return fillLayers(image, reserveLayers(div_x * div_y), div_x, div_y);
+}
+
+TextureData Texture::fillLayers(ImageData image, uint32_t start_layer, uint32_t div_x, uint32_t div_y)
+{
+	TextureData texture_data = { start_layer };
 
 	int width = glm::min(image.width / div_x, m_width);
 	int height = glm::min(image.height / div_y, m_height);
 	texture_data.coord = { (float)width / (float)m_width, (float)height / (float)m_height };
 
+	uint32_t layer = start_layer;
 	if (div_x == 1 && div_y == 1) {
 		if (m_target == GL_TEXTURE_2D)
 			fill(image.data, image.width, image.height);
-		else {
-			fill(image.data, image.width, image.height, 0, 0, m_next_layer);
-			m_next_layer++;
-		}
+		else
+			fill(image.data, image.width, image.height, 0, 0, layer);
 	} else {
 		if (div_x == 1) {
 			for (size_t y = 0; y < div_y; y++) {
 				int offset_buffer = y * height * image.width;
-				fill(image.data + offset_buffer * m_channel, width, height, 0, 0, m_next_layer);
-				m_next_layer++;
+				fill(image.data + offset_buffer * m_channel, width, height, 0, 0, layer);
+				layer++;
 			}
 		} else {
 			uint8_t* pixels = new uint8_t[width * height * m_channel];
@@ -127,8 +140,8 @@ TextureData Texture::fillImage(ImageData image, uint32_t div_x, uint32_t div_y)
 					int offset_buffer = x * width + y * image.width;
 					std::memcpy(pixels + offset_pixel * m_channel, image.data + offset_buffer * m_channel, width * m_channel);
 				}
-				fill(pixels, width, height, 0, 0, m_next_layer);
-				m_next_layer++;
+				fill(pixels, width, height, 0, 0, layer);
+				layer++;
 			}
 			delete[] pixels;
 		}
@@ -56,6 +56,8 @@ public:
 	void fill(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t offset_x = 0, uint32_t offset_y = 0, uint32_t layer = 0);
 	void fillFromBuffer(const std::unique_ptr<FrameBuffer>& fbo, uint32_t index = 0);
 	TextureData fillImage(ImageData image, uint32_t div_x = 1, uint32_t div_y = 1);
+	TextureData fillLayers(ImageData image, uint32_t start_layer, uint32_t div_x = 1, uint32_t div_y = 1);
+	uint32_t reserveLayers(uint32_t count);
 
 	inline const GLuint getId() const { return m_id; };
 	inline const uint32_t getSlot() const { return m_slot; };
@@ -18,8 +18,11 @@
 
 #include "pch.h"
 #include "upscaler.h"
+#include "asset_cache.h"
+#include "gpu_timer.h"
 #include "helpers.h"
 #include "option/ini.h"
+#include "profiler.h"
 
 #include <glslang/glslang.h>
 
@@ -27,14 +30,11 @@ namespace d2gl {
 
 Upscaler::Upscaler()
 {
-	auto buffer = helpers::loadFile("shaders\\list.txt");
-	if (!buffer.size)
+	auto asset = AssetCache::Instance().load("shaders\\list.txt");
+	if (!asset)
 		return;
 
-	std::string preset_list((const char*)buffer.data, buffer.size);
-	delete[] buffer.data;
-
-	auto lines = helpers::strToLines(preset_list);
+	auto lines = helpers::strToLines(asset->getString());
 	if (App.direct) {
 		std::string shader_path = helpers::getCurrentDir() + "data\\shaders\\";
 		if (std::filesystem::is_directory(shader_path)) {
@@ -56,13 +56,12 @@ Upscaler::Upscaler()
 	helpers::replaceAll(App.shader.preset, "/", "\\");
 	for (auto& line : lines) {
 		helpers::trimString(line, "\t\n\v\f\r ");
-		auto buf = helpers::loadFile("shaders\\" + line);
-		if (!buf.size)
+		auto preset = AssetCache::Instance().load("shaders\\" + line);
+		if (!preset)
 			return;
 
 		size_t pass_count = 1;
-		std::string preset_source((const char*)buf.data, buf.size);
-		delete[] buf.data;
+		std::string preset_source = preset->getString();
 
 		auto pos = preset_source.find("shaders =");
 		if (pos == std::string::npos)
@@ -91,15 +90,15 @@ bool Upscaler::loadPreset()
 	const auto preset_name = App.shader.presets.items[App.shader.presets.selected].value;
 	std::string preset_path = "shaders\\" + preset_name;
 
-	auto buffer = helpers::loadFile(preset_path);
-	if (!buffer.size)
+	auto asset = AssetCache::Instance().load(preset_path);
+	if (!asset)
 		return false;
 
-	std::string preset_source((const char*)buffer.data, buffer.size);
-	delete[] buffer.data;
+	std::string preset_source = asset->getString();
 
 	m_passes.clear();
 	m_textures.clear();
+	m_include_cache.clear();
 	std::unordered_map<std::string, TextureInfo> texture_info;
 	std::unordered_map<std::string, float> preset_params;
 
@@ -234,6 +233,9 @@ bool Upscaler::loadPreset()
 		}
 	}
 
+	eliminatePasses();
+
+	m_include_cache.clear();
 	option::saveString("Graphic", "shader_preset", preset_name);
 	return true;
 }
@@ -259,36 +261,68 @@ void Upscaler::setupPasses()
 
 	bool complete = true;
 
+	const size_t query_count = m_passes.size() * UPSCALER_QUERY_FRAMES;
+	if (m_timer_queries.size() != query_count) {
+		if (!m_timer_queries.empty())
+			glDeleteQueries(m_timer_queries.size(), m_timer_queries.data());
+		m_timer_queries.resize(query_count);
+		glGenQueries(query_count, m_timer_queries.data());
+	}
+	m_queries_issued.fill(false);
+
+	size_t first = 0;
+	while (m_passes[first].skip)
+		first++;
+
 	TextureCreateInfo texture_ci;
 	texture_ci.size = App.game.tex_size;
 	texture_ci.slot = TEXTURE_SLOT_DEFAULT;
-	if (m_passes[0].linear_filter)
+	if (m_passes[first].linear_filter)
 		texture_ci.filter = { GL_LINEAR, GL_LINEAR };
 	m_input_texture = Context::createTexture(texture_ci);
 
 	m_passes[0].out_size = App.game.tex_size;
+	m_passes[0].base_size = App.game.tex_size;
 	glm::uvec2 vwp_size = { (uint32_t)((float)App.game.tex_size.x * App.viewport.scale.x), (uint32_t)((float)App.game.tex_size.y * App.viewport.scale.y) };
 
 	for (size_t i = 0; i < m_passes.size(); i++) {
 		auto& pass = m_passes[i];
-		auto& prev = m_passes[i - (i > 0 ? 1 : 0)];
-		auto& next = m_passes[i + (i < m_passes.size() - 1 ? 1 : 0)];
+		const int src = getSourceIndex(i);
+		auto& prev = m_passes[src > 0 ? src : 0];
 		const bool is_last = (i == m_passes.size() - 1);
 
+		if (pass.skip) {
+			pass.base_size = prev.base_size;
+			pass.out_size = prev.out_size;
+			continue;
+		}
+
 		if (!is_last) {
 			if (pass.scale_type.x != ScaleType::Absolute)
-				pass.out_size.x = (uint32_t)((pass.scale_type.x == ScaleType::Source ? prev.out_size.x : vwp_size.x) * pass.scale_size.x);
+				pass.base_size.x = (uint32_t)((pass.scale_type.x == ScaleType::Source ? prev.base_size.x : vwp_size.x) * pass.scale_size.x);
 			else
-				pass.out_size.x = (uint32_t)pass.scale_size.x;
+				pass.base_size.x = (uint32_t)pass.scale_size.x;
 			if (pass.scale_type.y != ScaleType::Absolute)
-				pass.out_size.y = (uint32_t)((pass.scale_type.y == ScaleType::Source ? prev.out_size.y : vwp_size.y) * pass.scale_size.y);
+				pass.base_size.y = (uint32_t)((pass.scale_type.y == ScaleType::Source ? prev.base_size.y : vwp_size.y) * pass.scale_size.y);
 			else
-				pass.out_size.y = (uint32_t)pass.scale_size.y;
-		} else
+				pass.base_size.y = (uint32_t)pass.scale_size.y;
+
+			pass.out_size = pass.base_size;
+			if (pass.scale_type.x != ScaleType::Absolute)
+				pass.out_size.x = std::max((uint32_t)((float)pass.base_size.x * m_dynamic_scale), 1u);
+			if (pass.scale_type.y != ScaleType::Absolute)
+				pass.out_size.y = std::max((uint32_t)((float)pass.base_size.y * m_dynamic_scale), 1u);
+		} else {
+			pass.base_size = vwp_size;
 			pass.out_size = vwp_size;
+		}
 
 		if (!is_last) {
-			GLint filter = next.linear_filter ? GL_LINEAR : GL_NEAREST;
+			size_t n = i + 1;
+			while (m_passes[n].skip)
+				n++;
+
+			GLint filter = m_passes[n].linear_filter ? GL_LINEAR : GL_NEAREST;
 			FrameBufferCreateInfo frambuffer_ci;
 			frambuffer_ci.size = pass.out_size;
 			frambuffer_ci.attachments = { { i + 1, {}, { filter, filter }, pass.format } };
@@ -309,15 +343,15 @@ void Upscaler::setupPasses()
 			bindings.push_back({ BindingType::Texture, "Original", TEXTURE_SLOT_DEFAULT, &m_input_texture });
 		}
 		if (auto u = pass.getSamplerName("Source"); u != "") {
-			pass.pipeline->setUniform1i(u, i == 0 ? TEXTURE_SLOT_DEFAULT : i);
-			if (i == 0)
+			pass.pipeline->setUniform1i(u, src < 0 ? TEXTURE_SLOT_DEFAULT : src + 1);
+			if (src < 0)
 				bindings.push_back({ BindingType::Texture, "Source", TEXTURE_SLOT_DEFAULT, &m_input_texture });
 			else
-				bindings.push_back({ BindingType::FBTexture, "Source", i, &prev.frame_buffer });
+				bindings.push_back({ BindingType::FBTexture, "Source", (uint32_t)src + 1, &prev.frame_buffer });
 		}
 
 		if (auto u = pass.getUniformPrefixed("SourceSize"); u != "") {
-			if (i == 0)
+			if (src < 0)
 				pass.pipeline->setUniformVec4f(u, { (float)App.game.tex_size.x, (float)App.game.tex_size.y, 1.0f / (float)App.game.tex_size.x, 1.0f / (float)App.game.tex_size.y });
 			else
 				pass.pipeline->setUniformVec4f(u, { (float)prev.out_size.x, (float)prev.out_size.y, 1.0f / (float)prev.out_size.x, 1.0f / (float)prev.out_size.y });
@@ -336,19 +370,28 @@ void Upscaler::setupPasses()
 			for (size_t j = 0; j < i; j++) {
 				auto& p_pass = m_passes[j];
 				const glm::vec4 out_size = { (float)p_pass.out_size.x, (float)p_pass.out_size.y, 1.0f / (float)p_pass.out_size.x, 1.0f / (float)p_pass.out_size.y };
-				if (p_pass.name != "") {
-					if (auto u = pass.getSamplerName(p_pass.name); u != "") {
-						pass.pipeline->setUniform1i(u, j + 1);
-						bindings.push_back({ BindingType::FBTexture, u, j + 1, &p_pass.frame_buffer });
+
+				// A skipped pass hands out whatever it would have copied.
+				const int out = p_pass.skip ? getSourceIndex(j) : (int)j;
+				auto bindOutput = [&](const std::string& u) {
+					if (out < 0) {
+						pass.pipeline->setUniform1i(u, TEXTURE_SLOT_DEFAULT);
+						bindings.push_back({ BindingType::Texture, u, TEXTURE_SLOT_DEFAULT, &m_input_texture });
+					} else {
+						pass.pipeline->setUniform1i(u, out + 1);
+						bindings.push_back({ BindingType::FBTexture, u, (uint32_t)out + 1, &m_passes[out].frame_buffer });
 					}
+				};
+
+				if (p_pass.name != "") {
+					if (auto u = pass.getSamplerName(p_pass.name); u != "")
+						bindOutput(u);
 					if (auto u = pass.getUniformPrefixed(p_pass.name + "Size"); u != "")
 						pass.pipeline->setUniformVec4f(u, out_size);
 				}
 				const std::string num = std::to_string(j);
-				if (auto u = pass.getSamplerName("PassOutput" + num); u != "") {
-					pass.pipeline->setUniform1i(u, j + 1);
-					bindings.push_back({ BindingType::FBTexture, u, j + 1, &p_pass.frame_buffer });
-				}
+				if (auto u = pass.getSamplerName("PassOutput" + num); u != "")
+					bindOutput(u);
 				if (auto u = pass.getUniformPrefixed("PassOutputSize" + num); u != "")
 					pass.pipeline->setUniformVec4f(u, out_size);
 			}
@@ -378,11 +421,30 @@ void Upscaler::setupPasses()
 void Upscaler::process(const std::unique_ptr<FrameBuffer>& in_fbo, const glm::ivec2& vp_size, const glm::ivec2& vp_offset, const std::unique_ptr<FrameBuffer>& out_fbo)
 {
 	Context* ctx = App.context.get();
+
+	const bool timed = App.shader.dynamic_res.active || Profiler::Instance().isActive();
+	if (timed && collectTimerQueries() && App.shader.dynamic_res.active && updateDynamicScale())
+		setupPasses();
+
+	if (!App.shader.dynamic_res.active && m_dynamic_scale != 1.0f) {
+		m_dynamic_scale = 1.0f;
+		m_gpu_time = 0.0f;
+		setupPasses();
+	}
+
 	m_input_texture->fillFromBuffer(in_fbo);
 
+	const uint32_t query_slot = m_query_frame % UPSCALER_QUERY_FRAMES;
+	const size_t query_offset = query_slot * m_passes.size();
+
 	for (size_t i = 0; i < m_passes.size(); i++) {
 		const auto& pass = m_passes[i];
 		const bool is_last = (i == m_passes.size() - 1);
+		if (pass.skip)
+			continue;
+
+		if (timed)
+			glBeginQuery(GL_TIME_ELAPSED, m_timer_queries[query_offset + i]);
 
 		if (is_last) {
 			if (out_fbo) {
@@ -400,18 +462,98 @@ void Upscaler::process(const std::unique_ptr<FrameBuffer>& in_fbo, const glm::iv
 		if (pass.frame_count_uniform != "")
 			pass.pipeline->setUniform1u(pass.frame_count_uniform, ctx->getFrameCount());
 		ctx->drawQuad();
+
+		if (timed) {
+			glEndQuery(GL_TIME_ELAPSED);
+			GpuTimer::Instance().addQuery(GpuStage::Upscaler, m_timer_queries[query_offset + i]);
+		}
+	}
+
+	if (timed) {
+		m_queries_issued[query_slot] = true;
+		m_query_frame++;
 	}
 }
 
+bool Upscaler::collectTimerQueries()
+{
+	const uint32_t slot = m_query_frame % UPSCALER_QUERY_FRAMES;
+	if (!m_queries_issued[slot])
+		return false;
+
+	const size_t offset = slot * m_passes.size();
+	m_queries_issued[slot] = false;
+
+	GLint available = 0;
+	glGetQueryObjectiv(m_timer_queries[offset + m_passes.size() - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available)
+		return false;
+
+	m_gpu_time = 0.0f;
+	for (size_t i = 0; i < m_passes.size(); i++) {
+		GLuint64 elapsed = 0;
+		if (!m_passes[i].skip)
+			glGetQueryObjectui64v(m_timer_queries[offset + i], GL_QUERY_RESULT, &elapsed);
+		m_passes[i].gpu_time = (float)elapsed / 1000000.0f;
+		m_gpu_time += m_passes[i].gpu_time;
+	}
+
+	return true;
+}
+
+bool Upscaler::updateDynamicScale()
+{
+	// Drop quickly when over budget, but only climb back after a long run with clear headroom
+	// (one step up costs roughly 1.5x at the lowest scale) and hold still after every change.
+	if (m_cooldown) {
+		m_cooldown--;
+		return false;
+	}
+
+	const float budget = App.shader.dynamic_res.budget.value;
+	if (m_gpu_time > budget) {
+		m_over_budget++;
+		m_under_budget = 0;
+	} else if (m_gpu_time < budget * 0.6f) {
+		m_under_budget++;
+		m_over_budget = 0;
+	} else {
+		m_over_budget = 0;
+		m_under_budget = 0;
+	}
+
+	float scale = m_dynamic_scale;
+	if (m_over_budget >= 10)
+		scale = std::max(scale - 0.125f, 0.5f);
+	else if (m_under_budget >= 120)
+		scale = std::min(scale + 0.125f, 1.0f);
+	else
+		return false;
+
+	m_over_budget = 0;
+	m_under_budget = 0;
+	if (scale == m_dynamic_scale)
+		return false;
+
+	trace_log("Upscaler dynamic scale: %.3f (%.2f ms)", scale, m_gpu_time);
+	m_dynamic_scale = scale;
+	m_cooldown = 60;
+	return true;
+}
+
 bool Upscaler::prepareShader(ShaderPass& pass, std::string shader_path)
 {
-	auto buffer = helpers::loadFile(shader_path);
-	if (!buffer.size)
+	const auto shader_file = loadInclude(shader_path);
+	if (!shader_file)
 		return false;
 
-	std::string shader_source((const char*)buffer.data, buffer.size);
-	delete[] buffer.data;
-	resolveInclude(shader_source, shader_path);
+	IncludeState include_state;
+	include_state.included.push_back(shader_file->hash);
+	if (!shader_file->guard.empty())
+		include_state.guards.push_back(shader_file->guard);
+
+	std::string shader_source = shader_file->source;
+	resolveInclude(shader_source, shader_path, include_state);
 
 	uint8_t stage = 0;
 	std::string vert_source, frag_source;
@@ -474,6 +616,8 @@ bool Upscaler::prepareShader(ShaderPass& pass, std::string shader_path)
 	}
 	res1.source = res1.source.erase(0, res1.source.find("\n") + 1);
 	res2.source = res2.source.erase(0, res2.source.find("\n") + 1);
+	pass.identity = pass.params.empty() && isIdentityShader(vert_source, frag_source);
+
 	std::string source = "#ifdef VERTEX\n" + res1.source + "\n#elif FRAGMENT\n" + res2.source + "\n#endif";
 
 	PipelineCreateInfo pipeline_ci = { pass.name };
@@ -487,6 +631,8 @@ bool Upscaler::prepareShader(ShaderPass& pass, std::string shader_path)
 		pass.samplers.push_back(p);
 	for (const auto& p : res2.samplers)
 		pass.samplers.push_back(p);
+	if (pass.samplers.size() != 1 || pass.samplers[0] != "Source")
+		pass.identity = false;
 
 	for (const auto& p : res1.uniforms)
 		pass.uniforms[p.first] = p.second;
@@ -496,64 +642,239 @@ bool Upscaler::prepareShader(ShaderPass& pass, std::string shader_path)
 	return true;
 }
 
-void Upscaler::resolveInclude(std::string& source, std::string file_path)
+void Upscaler::eliminatePasses()
 {
-	bool dqm = false;
-	int s1 = -1, s2 = -1;
-	std::deque<std::pair<size_t, size_t>> cm_occurrences;
-
-	for (size_t i = 0; i < source.size() - 1; i++) {
-		const auto c0 = source[i];
-		const auto c1 = source[i + 1];
-		const bool end = i + 2 == source.size();
-		if (!dqm) {
-			if (s1 > -1 && (end || (c0 == '*' && c1 == '/'))) {
-				i++;
-				cm_occurrences.push_front({ s1, i + 1 - s1 });
-				s1 = -1;
-			} else if (s2 > -1 && (end || c0 == '\n' || c0 == '\r')) {
-				cm_occurrences.push_front({ s2, i + 1 - s2 });
-				s2 = -1;
-			} else if (s1 == -1 && s2 == -1 && c0 == '/') {
-				if (c1 == '*')
-					s1 = i;
-				else if (c1 == '/')
-					s2 = i;
-			}
+	// Drop passes that only copy Source texel for texel. The last pass always stays, it draws to screen.
+	size_t skipped = 0;
+	GLint src_format = GL_RGBA8;
+	for (size_t i = 0; i < m_passes.size(); i++) {
+		auto& pass = m_passes[i];
+		const bool is_last = (i == m_passes.size() - 1);
+		const bool same_size = pass.scale_type.x == ScaleType::Source && pass.scale_type.y == ScaleType::Source && pass.scale_size == glm::vec2(1.0f);
+
+		pass.skip = !is_last && pass.identity && same_size && pass.format.first == src_format;
+		if (pass.skip) {
+			trace_log("Upscaler: %s eliminated (identity copy).", pass.label.c_str());
+			skipped++;
 		}
-		if (s1 == -1 && s2 == -1 && c0 == '"')
-			dqm = !dqm;
+		src_format = pass.format.first;
 	}
 
-	for (auto& p : cm_occurrences)
-		source.erase(p.first, p.second);
+	if (skipped)
+		trace_log("Upscaler: %zu of %zu passes eliminated.", skipped, m_passes.size());
+}
 
-	size_t start = 0;
-	std::deque<std::tuple<size_t, size_t, std::string>> inc_occurrences;
+int Upscaler::getSourceIndex(size_t index) const
+{
+	int i = (int)index - 1;
+	while (i >= 0 && m_passes[i].skip)
+		i--;
+
+	return i;
+}
+
+void Upscaler::resolveInclude(std::string& source, const std::string& file_path, IncludeState& state)
+{
+	if (state.depth > 32) {
+		error_log("Shader include depth exceeded! %s", file_path.c_str());
+		source.clear();
+		return;
+	}
+
+	std::string result;
+	result.reserve(source.size());
 
-	while ((start = source.find("#include", start)) != std::string::npos) {
-		size_t s_pos = start + 9;
-		size_t e_pos = source.find("\n", s_pos);
-		e_pos = e_pos == std::string::npos ? source.length() : e_pos;
-		std::string inc_file = source.substr(s_pos, e_pos - s_pos);
+	size_t start = 0;
+	while (start < source.size()) {
+		size_t end = source.find('\n', start);
+		end = end == std::string::npos ? source.size() : end + 1;
+
+		const size_t pos = source.find_first_not_of(" \t", start);
+		if (pos >= end || source.compare(pos, 8, "#include") != 0) {
+			result.append(source, start, end - start);
+			start = end;
+			continue;
+		}
 
+		std::string inc_file = source.substr(pos + 8, end - pos - 8);
 		helpers::trimString(inc_file, "\t\n\v\f\r ");
-		inc_file.erase(std::remove(inc_file.begin(), inc_file.end(), '"'), inc_file.end());
-		inc_occurrences.push_front({ start, e_pos - start, inc_file });
-		start += 9;
+		inc_file.erase(std::remove_if(inc_file.begin(), inc_file.end(), [](char c) { return c == '"' || c == '<' || c == '>'; }), inc_file.end());
+
+		const auto inc_path = helpers::filePathFix(file_path, inc_file);
+		const auto inc = loadInclude(inc_path);
+		if (!inc) {
+			result.append(source, start, end - start);
+			start = end;
+			continue;
+		}
+
+		const bool once = inc->pragma_once && std::find(state.included.begin(), state.included.end(), inc->hash) != state.included.end();
+		const bool guarded = !inc->guard.empty() && std::find(state.guards.begin(), state.guards.end(), inc->guard) != state.guards.end();
+		if (!once && !guarded) {
+			state.included.push_back(inc->hash);
+			if (!inc->guard.empty())
+				state.guards.push_back(inc->guard);
+
+			std::string inc_source = inc->source;
+			state.depth++;
+			resolveInclude(inc_source, inc_path, state);
+			state.depth--;
+			result += inc_source;
+		}
+		result += '\n';
+		start = end;
+	}
+
+	source = std::move(result);
+}
+
+const IncludeFile* Upscaler::loadInclude(const std::string& file_path)
+{
+	std::string key = file_path;
+	helpers::strToLower(key);
+	if (auto it = m_include_cache.find(key); it != m_include_cache.end())
+		return &it->second;
+
+	auto asset = AssetCache::Instance().load(file_path);
+	if (!asset)
+		return nullptr;
+
+	IncludeFile inc;
+	inc.hash = helpers::hash(asset->getData(), asset->getSize());
+	const auto source = stripComments(asset->getString());
+	inc.source.reserve(source.size());
+
+	std::string first_directive = "", guard_define = "";
+	int if_depth = 0;
+	bool guard_closed = false, guard_valid = true;
+	size_t start = 0;
+	while (start < source.size()) {
+		size_t end = source.find('\n', start);
+		end = end == std::string::npos ? source.size() : end + 1;
+
+		std::string line = source.substr(start, end - start);
+		helpers::trimString(line, "\t\n\v\f\r ");
+		if (line.compare(0, 7, "#pragma") == 0) {
+			std::string pragma = line.substr(7);
+			helpers::trimString(pragma, "\t ");
+			if (pragma == "once") {
+				inc.pragma_once = true;
+				inc.source += '\n';
+				start = end;
+				continue;
+			}
+		}
+		inc.source.append(source, start, end - start);
+		start = end;
+
+		if (line.empty())
+			continue;
+		if (guard_closed)
+			guard_valid = false;
+		if (first_directive.empty())
+			first_directive = line;
+		else if (guard_define.empty())
+			guard_define = line;
+
+		if (line.compare(0, 3, "#if") == 0)
+			if_depth++;
+		else if (line.compare(0, 6, "#endif") == 0 && --if_depth == 0)
+			guard_closed = true;
 	}
 
-	for (auto& p : inc_occurrences) {
-		auto inc_file = helpers::filePathFix(file_path, std::get<2>(p));
-		std::string inc_file_source = "";
-		auto buffer = helpers::loadFile(inc_file);
-		if (buffer.size) {
-			inc_file_source = std::string((const char*)buffer.data, buffer.size);
-			delete[] buffer.data;
-			resolveInclude(inc_file_source, inc_file);
-			source.replace(std::get<0>(p), std::get<1>(p), inc_file_source);
+	if (guard_valid && guard_closed && first_directive.compare(0, 7, "#ifndef") == 0) {
+		std::string guard = first_directive.substr(7);
+		helpers::trimString(guard, "\t ");
+		if (!guard.empty() && guard_define.compare(0, 7, "#define") == 0) {
+			std::string define = guard_define.substr(7);
+			helpers::trimString(define, "\t ");
+			if (define.substr(0, define.find_first_of(" \t")) == guard)
+				inc.guard = guard;
 		}
 	}
+
+	return &(m_include_cache[key] = std::move(inc));
+}
+
+std::string Upscaler::stripComments(const std::string& source)
+{
+	std::string result;
+	result.reserve(source.size());
+
+	bool dqm = false;
+	const size_t size = source.size();
+	for (size_t i = 0; i < size; i++) {
+		const char c0 = source[i];
+		const char c1 = i + 1 < size ? source[i + 1] : '\0';
+
+		if (!dqm && c0 == '/' && c1 == '/') {
+			while (i + 1 < size && source[i + 1] != '\n' && source[i + 1] != '\r')
+				i++;
+			continue;
+		}
+		if (!dqm && c0 == '/' && c1 == '*') {
+			for (i += 2; i < size && !(source[i] == '*' && i + 1 < size && source[i + 1] == '/'); i++) {
+				if (source[i] == '\n')
+					result += '\n';
+			}
+			result += ' ';
+			i++;
+			continue;
+		}
+
+		if (c0 == '"')
+			dqm = !dqm;
+		else if (c0 == '\n')
+			dqm = false;
+		result += c0;
+	}
+
+	return result;
+}
+
+std::string Upscaler::getMainBody(const std::string& source)
+{
+	size_t pos = source.find("void main");
+	if (pos == std::string::npos || (pos = source.find('{', pos)) == std::string::npos)
+		return "";
+
+	std::string body;
+	int depth = 0;
+	for (size_t i = pos; i < source.size(); i++) {
+		const char c = source[i];
+		if (c == '{')
+			depth++;
+		else if (c == '}' && --depth == 0)
+			break;
+		if (depth > 0 && i > pos && !std::isspace((unsigned char)c))
+			body += c;
+	}
+
+	return depth == 0 ? body : "";
+}
+
+bool Upscaler::isIdentityShader(const std::string& vert_source, const std::string& frag_source)
+{
+	static const std::vector<std::string> vert_bodies = {
+		"gl_Position=global.MVP*Position;vTexCoord=TexCoord;",
+		"gl_Position=params.MVP*Position;vTexCoord=TexCoord;",
+	};
+	static const std::vector<std::string> frag_exprs = {
+		"texture(Source,vTexCoord);",
+		"texture(Source,vTexCoord).rgba;",
+		"vec4(texture(Source,vTexCoord));",
+	};
+
+	const auto vert_body = getMainBody(vert_source);
+	if (std::find(vert_bodies.begin(), vert_bodies.end(), vert_body) == vert_bodies.end())
+		return false;
+
+	const auto frag_body = getMainBody(frag_source);
+	const size_t pos = frag_body.find('=');
+	if (pos == std::string::npos || frag_body.find(';') != frag_body.size() - 1)
+		return false;
+
+	return std::find(frag_exprs.begin(), frag_exprs.end(), frag_body.substr(pos + 1)) != frag_exprs.end();
 }
 
 std::pair<GLint, GLenum> Upscaler::getFramebufferFormat(const std::string& format)
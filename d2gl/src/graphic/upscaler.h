@@ -20,6 +20,8 @@
 
 #include "pipeline.h"
 
+#define UPSCALER_QUERY_FRAMES 3
+
 namespace d2gl {
 
 enum class ScaleType {
@@ -48,10 +50,14 @@ struct ShaderPass {
 	std::string label;
 	std::string name = "";
 	glm::vec<2, uint32_t> out_size = { 0, 0 };
+	glm::vec<2, uint32_t> base_size = { 0, 0 };
 	glm::vec<2, ScaleType> scale_type = { ScaleType::Source, ScaleType::Source };
 	glm::vec2 scale_size = { 1.0f, 1.0f };
 	bool linear_filter = false;
 	std::string frame_count_uniform = "";
+	float gpu_time = 0.0f;
+	bool identity = false;
+	bool skip = false;
 
 	std::vector<ShaderParam> params;
 	std::unique_ptr<Pipeline> pipeline;
@@ -64,10 +70,33 @@ struct ShaderPass {
 	inline std::string getUniformPrefixed(const std::string& uniform) const { return uniforms.find(uniform) != uniforms.end() ? uniforms.at(uniform) + "." + uniform : ""; }
 };
 
+struct IncludeFile {
+	uint32_t hash = 0;
+	std::string source = "";
+	std::string guard = "";
+	bool pragma_once = false;
+};
+
+struct IncludeState {
+	std::vector<uint32_t> included;
+	std::vector<std::string> guards;
+	uint32_t depth = 0;
+};
+
 class Upscaler {
 	std::vector<ShaderPass> m_passes = {};
 	std::unique_ptr<Texture> m_input_texture;
 	std::unordered_map<std::string, std::unique_ptr<Texture>> m_textures;
+	std::unordered_map<std::string, IncludeFile> m_include_cache;
+
+	std::vector<GLuint> m_timer_queries;
+	std::array<bool, UPSCALER_QUERY_FRAMES> m_queries_issued = {};
+	uint32_t m_query_frame = 0;
+	float m_dynamic_scale = 1.0f;
+	float m_gpu_time = 0.0f;
+	uint32_t m_over_budget = 0;
+	uint32_t m_under_budget = 0;
+	uint32_t m_cooldown = 0;
 
 	Upscaler();
 	~Upscaler() = default;
@@ -84,10 +113,23 @@ public:
 	void setupPasses();
 	void process(const std::unique_ptr<FrameBuffer>& in_fbo, const glm::ivec2& vp_size, const glm::ivec2& vp_offset, const std::unique_ptr<FrameBuffer>& out_fbo = nullptr);
 
+	inline float getDynamicScale() { return m_dynamic_scale; }
+	inline float getGpuTime() { return m_gpu_time; }
+	inline const std::vector<ShaderPass>& getPasses() { return m_passes; }
+
 private:
 	bool prepareShader(ShaderPass& pass, std::string shader_path);
+	void eliminatePasses();
+	int getSourceIndex(size_t index) const;
+	bool collectTimerQueries();
+	bool updateDynamicScale();
+
+	void resolveInclude(std::string& source, const std::string& file_path, IncludeState& state);
+	const IncludeFile* loadInclude(const std::string& file_path);
 
-	static void resolveInclude(std::string& source, std::string file_path);
+	static std::string stripComments(const std::string& source);
+	static std::string getMainBody(const std::string& source);
+	static bool isIdentityShader(const std::string& vert_source, const std::string& frag_source);
 	static std::pair<GLint, GLenum> getFramebufferFormat(const std::string& format);
 };
 
@@ -68,6 +68,66 @@ struct VertexMod {
 	}
 };
 
+// One mod quad: drawn as an instance, or expanded to four VertexMod without instancing.
+// It is 36 bytes against 128 for four VertexMod. Every field reaches the shader at the
+// precision VertexMod already had, so there is nothing left to drop to get it to 32.
+// tex_rect is signed fixed point in 1/16384 steps (-2 to 2), the minimap samples outside
+// 0..1 when it is larger than the game view.
+struct QuadMod {
+	glm::vec<4, int16_t> rect;
+	glm::vec<4, int16_t> tex_rect;
+	uint32_t color1;
+	uint32_t color2;
+	glm::vec<2, uint16_t> tex_ids;
+	glm::vec<4, uint8_t> flags;
+	glm::vec<2, int16_t> extra;
+
+	static void bindingDescription()
+	{
+		glEnableVertexAttribArray(6);
+		glVertexAttribPointer(0, 4, GL_HALF_FLOAT, GL_FALSE, sizeof(QuadMod), (const void*)offsetof(QuadMod, rect));
+		glVertexAttribPointer(1, 4, GL_SHORT, GL_FALSE, sizeof(QuadMod), (const void*)offsetof(QuadMod, tex_rect));
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadMod), (const void*)offsetof(QuadMod, color1));
+		glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadMod), (const void*)offsetof(QuadMod, color2));
+		glVertexAttribIPointer(4, 2, GL_UNSIGNED_SHORT, sizeof(QuadMod), (const void*)offsetof(QuadMod, tex_ids));
+		glVertexAttribIPointer(5, 4, GL_UNSIGNED_BYTE, sizeof(QuadMod), (const void*)offsetof(QuadMod, flags));
+		glVertexAttribPointer(6, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(QuadMod), (const void*)offsetof(QuadMod, extra));
+		setDivisor(1);
+	}
+
+	static void setDivisor(uint32_t divisor)
+	{
+		for (uint32_t i = 0; i <= 6; i++)
+			glVertexAttribDivisor(i, divisor);
+	}
+
+	static inline int16_t toTexFixed(float value) { return (int16_t)glm::round(glm::clamp(value, -2.0f, 32767.0f / 16384.0f) * 16384.0f); }
+	static inline glm::vec<4, int16_t> toTexRect(glm::vec4 tex_coord) { return { toTexFixed(tex_coord.x), toTexFixed(tex_coord.w), toTexFixed(tex_coord.z), toTexFixed(tex_coord.y) }; }
+
+	// Corner order matches Object: top-left, top-right, bottom-right, bottom-left.
+	void expand(VertexMod* vertices) const
+	{
+		const glm::vec2 tex0 = glm::vec2(tex_rect.x, tex_rect.y) / 16384.0f;
+		const glm::vec2 tex1 = glm::vec2(tex_rect.z, tex_rect.w) / 16384.0f;
+
+		for (int i = 0; i < 4; i++) {
+			vertices[i].color1 = color1;
+			vertices[i].color2 = color2;
+			vertices[i].tex_ids = tex_ids;
+			vertices[i].flags = flags;
+			vertices[i].extra = extra;
+		}
+		vertices[0].position = { rect.x, rect.y };
+		vertices[1].position = { rect.z, rect.y };
+		vertices[2].position = { rect.z, rect.w };
+		vertices[3].position = { rect.x, rect.w };
+		vertices[0].tex_coord = { tex0.x, tex0.y };
+		vertices[1].tex_coord = { tex1.x, tex0.y };
+		vertices[2].tex_coord = { tex1.x, tex1.y };
+		vertices[3].tex_coord = { tex0.x, tex1.y };
+	}
+};
+
 struct GlideVertex {
 	float x, y;
 	uint32_t pargb;
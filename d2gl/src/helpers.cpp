@@ -18,6 +18,7 @@
 
 #include "pch.h"
 #include "helpers.h"
+#include "asset_cache.h"
 #include "d2/common.h"
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -360,50 +361,25 @@ uint32_t hash(const void* key, size_t len)
 
 BufferData loadFile(const std::string& file_path)
 {
-	static bool is_mpq_loaded = false;
-	if (!is_mpq_loaded) {
-		std::string mpq_path = getCurrentDir() + App.mpq_file;
-		if (!d2::mpqLoad(mpq_path.c_str()))
-			error_log("%s not loaded.", mpq_path.c_str());
-		is_mpq_loaded = true;
-	}
-
-	std::string path = std::string("data\\").append(file_path);
-
-	void* ref_file;
-	char c_filepath[MAX_PATH];
-	strncpy_s(c_filepath, path.c_str(), path.size());
-
-	if (d2::mpqOpenFile && d2::mpqOpenFile(c_filepath, &ref_file)) {
-		size_t return_size = 0;
-		DWORD fileSize = d2::mpqGetFileSize(ref_file, NULL);
-		uint8_t* cache = new uint8_t[fileSize + 1];
-
-		if (d2::mpqReadFile(ref_file, cache, fileSize, &return_size, NULL, NULL, NULL)) {
-			d2::mpqCloseFile(ref_file);
-
-			cache[fileSize] = 0;
-			return { return_size, cache };
-		} else
-			error_log("File (MPQ): \"%s\" read error.", path.c_str());
-
-		delete[] cache;
+	auto asset = AssetCache::Instance().load(file_path);
+	if (!asset)
 		return { 0 };
-	} else
-		error_log("File (MPQ): \"%s\" could not opened!", path.c_str());
 
-	return { 0 };
+	uint8_t* data = new uint8_t[asset->getSize() + 1];
+	memcpy(data, asset->getData(), asset->getSize());
+	data[asset->getSize()] = 0;
+
+	return { asset->getSize(), data };
 }
 
 ImageData loadImage(const std::string& file_path, bool flipped)
 {
 	ImageData image = { 0 };
 
-	auto buffer = loadFile(file_path);
-	if (buffer.size) {
-		stbi_set_flip_vertically_on_load(flipped);
-		image.data = stbi_load_from_memory(buffer.data, buffer.size, &image.width, &image.height, &image.bit, 4);
-		delete[] buffer.data;
+	auto asset = AssetCache::Instance().load(file_path);
+	if (asset) {
+		stbi_set_flip_vertically_on_load_thread(flipped);
+		image.data = stbi_load_from_memory(asset->getData(), asset->getSize(), &image.width, &image.height, &image.bit, 4);
 	}
 
 	return image;
@@ -20,18 +20,19 @@
 #include "hd_cursor.h"
 #include "d2/common.h"
 #include "d2/funcs.h"
-#include "helpers.h"
 
 namespace d2gl::modules {
 
 CursorObject::CursorObject(const std::unique_ptr<Texture>& texture, const std::string& file_name, uint32_t frames, glm::vec2 offset)
 	: m_offset(offset)
 {
-	auto image_data = helpers::loadImage(file_name);
-	auto tex_data = texture->fillImage(image_data, frames);
-	helpers::clearImage(image_data);
+	m_start_layer = texture->reserveLayers(frames);
+	AssetLoader::Instance().loadImage(file_name, true, [this, texture = texture.get(), frames](const ImageData& image) {
+		if (image.data)
+			texture->fillLayers(image, m_start_layer, frames);
+		m_ready = true;
+	});
 
-	m_start_layer = tex_data.start_layer;
 	m_object = std::make_unique<Object>(glm::vec2(0.0f, 0.0f), glm::vec2(40.0f, 40.0f));
 	m_object->setFlags(1);
 }
@@ -60,7 +61,7 @@ HDCursor::HDCursor()
 
 void HDCursor::draw()
 {
-	if (!App.hd_cursor)
+	if (!App.hd_cursor || !isReady())
 		return;
 
 	// clang-format off
@@ -35,12 +35,14 @@ class CursorObject {
 	std::unique_ptr<Object> m_object;
 	uint32_t m_start_layer;
 	glm::vec2 m_offset;
+	std::atomic<bool> m_ready = false;
 
 public:
 	CursorObject(const std::unique_ptr<Texture>& texture, const std::string& file_name, uint32_t frames, glm::vec2 offset);
 	~CursorObject() = default;
 
 	void draw(uint8_t frame);
+	inline bool isReady() { return m_ready; }
 };
 
 class HDCursor {
@@ -64,6 +66,7 @@ public:
 	}
 
 	void draw();
+	inline bool isReady() { return m_hand_cursor->isReady() && m_other_cursor->isReady(); }
 	CursorType getCursorType();
 	void mouseProc(UINT uMsg);
 };
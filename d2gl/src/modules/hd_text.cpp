@@ -18,11 +18,14 @@
 
 #include "pch.h"
 #include "hd_text.h"
+#include "asset_cache.h"
+#include "hd_text/dynamic_atlas.h"
 #include "d2/common.h"
 #include "d2/stubs.h"
 #include "modules/mini_map.h"
 #include "modules/motion_prediction.h"
 #include "option/menu.h"
+#include "profiler.h"
 
 namespace d2gl::modules {
 
@@ -32,16 +35,14 @@ HDText::HDText()
 	m_object_bg = std::make_unique<Object>();
 
 	std::string lang_file = helpers::getLangString(true);
-	auto buffer = helpers::loadFile("assets\\atlases\\" + lang_file + ".txt");
-	if (!buffer.size && m_lang_id == LANG_SIN)
-		buffer = helpers::loadFile("assets\\atlases\\chi.txt");
-	if (!buffer.size)
-		buffer = helpers::loadFile("assets\\atlases\\default.txt");
+	auto asset = AssetCache::Instance().load("assets\\atlases\\" + lang_file + ".txt");
+	if (!asset && m_lang_id == LANG_SIN)
+		asset = AssetCache::Instance().load("assets\\atlases\\chi.txt");
+	if (!asset)
+		asset = AssetCache::Instance().load("assets\\atlases\\default.txt");
 
-	if (buffer.size) {
-		std::string data((const char*)buffer.data, buffer.size);
-		auto lines = helpers::strToLines(data);
-		delete[] buffer.data;
+	if (asset) {
+		auto lines = helpers::strToLines(asset->getString());
 
 		TextureCreateInfo texture_ci;
 		texture_ci.layer_count = 1;
@@ -51,6 +52,7 @@ HDText::HDText()
 
 		static std::unordered_map<std::string, GlyphSet*> glyph_sets;
 		std::vector<std::vector<std::string>> info_list;
+		bool dynamic_atlas = GlyphSet::hasFont("NotoSymbol");
 		for (auto& line : lines) {
 			helpers::replaceAll(line, " ", "");
 			helpers::replaceAll(line, "\r", "");
@@ -58,23 +60,20 @@ HDText::HDText()
 			auto info = helpers::splitToVector(line, '|');
 			if (info.size() > 9) {
 				if (glyph_sets.find(info[1]) == glyph_sets.end()) {
-					auto buffer2 = helpers::loadFile("assets\\atlases\\" + info[1] + "\\data.csv");
-					if (buffer2.size) {
-						auto pos = (buffer2.data + (buffer2.size - 5));
-						while (*pos != '\n' || pos == buffer2.data)
-							pos--;
-						std::string num = std::string((const char*)(pos + 1), 2);
-						helpers::replaceAll(num, ",", "");
-						texture_ci.layer_count += std::atoi(num.c_str()) + 1;
-						delete[] buffer2.data;
-					}
+					texture_ci.layer_count += GlyphSet::getPageCount(info[1], texture_ci.size);
+					dynamic_atlas |= GlyphSet::hasFont(info[1]);
 					glyph_sets.insert({ info[1], nullptr });
 				}
 				info_list.push_back(info);
 			}
 		}
 
+		if (dynamic_atlas)
+			texture_ci.layer_count += DYNAMIC_ATLAS_PAGES;
+
 		static std::unique_ptr<Texture> texture = Context::createTexture(texture_ci);
+		if (dynamic_atlas)
+			DynamicAtlas::Instance().init(texture.get());
 		static auto symbol_set = new GlyphSet(texture.get(), "NotoSymbol");
 
 		for (auto& info : info_list) {
@@ -91,6 +90,12 @@ HDText::HDText()
 			m_fonts[id] = std::make_unique<Font>(glyph_sets[name], font_ci);
 		}
 
+		m_glyph_sets.push_back(symbol_set);
+		for (auto& glyph_set : glyph_sets) {
+			if (glyph_set.second)
+				m_glyph_sets.push_back(glyph_set.second);
+		}
+
 		if (m_lang_id != LANG_ENG && m_lang_id != LANG_DEF) {
 			if (m_lang_id != LANG_POR && m_lang_id != LANG_SIN && m_lang_id != LANG_RUS) {
 				for (size_t i = 0; i < g_options_texts.size(); i++)
@@ -131,6 +136,13 @@ HDText::HDText()
 
 void HDText::reset()
 {
+	const ProfileScope scope(ProfileModule::HDText);
+	DynamicAtlas::Instance().update();
+	LayoutCache::Instance().nextFrame();
+
+	if (!m_loaded)
+		m_loaded = std::all_of(m_glyph_sets.begin(), m_glyph_sets.end(), [](GlyphSet* glyph_set) { return glyph_set->isReady(); });
+
 	m_masking = false;
 	m_map_text_line = 1;
 	m_is_player_dead = d2::isUnitDead(d2::getPlayerUnit());
@@ -138,6 +150,7 @@ void HDText::reset()
 
 void HDText::update()
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	static bool mask = false;
 	if (App.game.screen == GameScreen::Menu) {
 		static glm::vec4 text_mask = glm::vec4(0.0f);
@@ -158,6 +171,7 @@ void HDText::update()
 
 bool HDText::drawText(const wchar_t* str, int x, int y, uint32_t color, uint32_t centered, uint32_t trans_lvl)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	if (!isActive() || !str)
 		return false;
 
@@ -205,13 +219,13 @@ bool HDText::drawText(const wchar_t* str, int x, int y, uint32_t color, uint32_t
 	if (!ISGLIDE3X())
 		pos.y += font->getFontSize() * 0.08f;
 
+	auto run = font->layoutText(str);
 	if (App.game.draw_stage == DrawStage::Map && m_text_size == 6 && *d2::screen_shift != SCREENPANEL_NONE) {
 		const auto center = (int)(*d2::screen_width / 2);
 		if (*d2::screen_shift == SCREENPANEL_LEFT && x < center)
 			return true;
 		if (*d2::screen_shift == SCREENPANEL_RIGHT) {
-			const auto size = font->getTextSize(str);
-			if (x + (int)size.x > center)
+			if (x + (int)run->size.x > center)
 				return true;
 		}
 	}
@@ -230,7 +244,8 @@ bool HDText::drawText(const wchar_t* str, int x, int y, uint32_t color, uint32_t
 
 			bool hidden = *d2::automap_on || d2::isEscMenuOpen();
 			font = getFont(m_map_text_line == 1 || !App.mini_map.text_over || hidden ? 19 : 6);
-			const auto size = font->getTextSize(str);
+			run = font->layoutText(str);
+			const auto size = run->size;
 
 			if (m_map_text_line == 1) {
 				pos.x = App.game.size.x - modules::MiniMap::Instance().getTimeWidth() - size.x - 5.0f;
@@ -251,7 +266,7 @@ bool HDText::drawText(const wchar_t* str, int x, int y, uint32_t color, uint32_t
 	}
 
 	if (m_text_size == 13 && (x == 15 || (*d2::screen_shift == SCREENPANEL_LEFT && x == App.game.size.x / 2 + 15))) {
-		auto size = font->getTextSize(str);
+		const auto size = run->size;
 		const glm::vec2 padding = { 4.0f, 2.0f };
 		glm::vec2 back_pos = { pos.x, pos.y - size.y };
 
@@ -273,7 +288,7 @@ bool HDText::drawText(const wchar_t* str, int x, int y, uint32_t color, uint32_t
 	}
 	font->setMasking(m_masking);
 	font->setAlign(TextAlign::Left);
-	font->drawText(str, pos, text_color);
+	font->drawText(*run, pos, text_color);
 	font->setOpacity(1.0f);
 
 	if (map_text) {
@@ -286,6 +301,7 @@ bool HDText::drawText(const wchar_t* str, int x, int y, uint32_t color, uint32_t
 
 bool HDText::drawFramedText(const wchar_t* str, int x, int y, uint32_t color, uint32_t centered)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	if (!str || !isActive())
 		return false;
 
@@ -311,11 +327,13 @@ bool HDText::drawFramedText(const wchar_t* str, int x, int y, uint32_t color, ui
 	auto font = getFont(1);
 	const auto text_color = g_text_colors.at(getColor(color));
 	glm::vec2 pos, padding, box_size, size;
+	std::shared_ptr<const TextRun> run;
 
 	if (unit && unit->dwType == d2::UnitType::Item) {
 		font = getFont(16);
-		size = font->getTextSize(str);
-		line_count = font->getLineCount();
+		run = font->layoutText(str);
+		size = run->size;
+		line_count = run->line_count;
 		font_size = font->getFontSize();
 
 		padding = { 3.4f, glm::max(1.4f, (18.0f - font_size) / 2.0f) };
@@ -325,12 +343,14 @@ bool HDText::drawFramedText(const wchar_t* str, int x, int y, uint32_t color, ui
 		m_object_bg->setFlags(2);
 	} else {
 		font = getFont(14);
-		size = font->getTextSize(str);
-		line_count = font->getLineCount();
+		run = font->layoutText(str);
+		size = run->size;
+		line_count = run->line_count;
 		font_size = font->getFontSize();
 		if (size.y > (float)App.game.size.y - 40.0f) {
 			font = getFont(15);
-			size = font->getTextSize(str);
+			run = font->layoutText(str);
+			size = run->size;
 			font_size = font->getFontSize();
 		}
 
@@ -388,7 +408,7 @@ bool HDText::drawFramedText(const wchar_t* str, int x, int y, uint32_t color, ui
 	font->setShadow(0);
 	font->setMasking(false);
 	font->setAlign(TextAlign::Center);
-	font->drawText(str, pos + padding, text_color, true);
+	font->drawText(*run, pos + padding, text_color, true);
 	App.context->toggleDelayPush(false);
 
 	return true;
@@ -396,6 +416,7 @@ bool HDText::drawFramedText(const wchar_t* str, int x, int y, uint32_t color, ui
 
 bool HDText::drawRectangledText(const wchar_t* str, int x, int y, uint32_t rect_transparency, uint32_t color)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	if (!isActive() || !str)
 		return false;
 
@@ -409,10 +430,12 @@ bool HDText::drawRectangledText(const wchar_t* str, int x, int y, uint32_t rect_
 	const auto text_color = g_text_colors.at(getColor(color));
 	uint32_t bg_color = m_bg_color;
 	glm::vec2 padding, back_pos, text_pos, size;
+	std::shared_ptr<const TextRun> run;
 
 	if (rect_transparency == 2) {
-		size = font->getTextSize(str);
-		line_count = font->getLineCount();
+		run = font->layoutText(str);
+		size = run->size;
+		line_count = run->line_count;
 		font_size = font->getFontSize();
 
 		padding = { 10.0f, 5.0f };
@@ -424,8 +447,9 @@ bool HDText::drawRectangledText(const wchar_t* str, int x, int y, uint32_t rect_
 		m_object_bg->setExtra(size + padding * 2.0f);
 	} else {
 		font = getFont(16);
-		size = font->getTextSize(str);
-		line_count = font->getLineCount();
+		run = font->layoutText(str);
+		size = run->size;
+		line_count = run->line_count;
 		font_size = font->getFontSize();
 
 		padding = { 3.4f, glm::max(1.4f, (18.0f - font_size) / 2.0f) };
@@ -456,13 +480,14 @@ bool HDText::drawRectangledText(const wchar_t* str, int x, int y, uint32_t rect_
 	font->setShadow(1);
 	font->setMasking(false);
 	font->setAlign(TextAlign::Center);
-	font->drawText(str, text_pos + padding, text_color, true);
+	font->drawText(*run, text_pos + padding, text_color, true);
 
 	return true;
 }
 
 bool HDText::drawSolidRect(int left, int top, int right, int bottom, uint32_t color, int draw_mode)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	if (App.game.screen != GameScreen::InGame || !isActive())
 		return false;
 
@@ -539,6 +564,7 @@ bool HDText::drawSolidRect(int left, int top, int right, int bottom, uint32_t co
 
 uint32_t HDText::getNormalTextWidth(const wchar_t* str, const int n_chars)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	if (App.game.draw_stage == DrawStage::Map && modules::MiniMap::Instance().isActive() && m_text_size == 6 && !*d2::automap_on)
 		return n_chars > 0 ? d2::getNormalTextNWidth(str, n_chars) : d2::getNormalTextWidth(str);
 
@@ -550,12 +576,13 @@ uint32_t HDText::getNormalTextWidth(const wchar_t* str, const int n_chars)
 
 uint32_t HDText::getFramedTextSize(const wchar_t* str, uint32_t* width, uint32_t* height)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	uint32_t text_size = m_text_size == 1? 16 : m_text_size;
 	const auto font = getFont(text_size);
-	const auto size = font->getTextSize(str);
+	const auto run = font->layoutText(str);
 
-	*width = (uint32_t)(size.x + (text_size == 1 ? 10 : 0));
-	*height = text_size == 1 ? (font->getLineCount() * 18 + 2) : (uint32_t)size.y;
+	*width = (uint32_t)(run->size.x + (text_size == 1 ? 10 : 0));
+	*height = text_size == 1 ? (run->line_count * 18 + 2) : (uint32_t)run->size.y;
         if (m_text_size == 1) {
 		*height += (uint32_t)(font->getLineHeight() / 4);
 	}
@@ -634,6 +661,7 @@ void HDText::drawSubText(uint8_t fn)
 
 bool HDText::drawImage(d2::CellContext* cell, int x, int y, int draw_mode)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	if (!isActive() || !cell)
 		return true;
 
@@ -700,6 +728,7 @@ bool HDText::drawImage(d2::CellContext* cell, int x, int y, int draw_mode)
 
 bool HDText::drawShiftedImage(d2::CellContext* cell, int x, int y)
 {
+	const ProfileScope scope(ProfileModule::HDText);
 	if (!isActive())
 		return true;
 
@@ -864,7 +893,8 @@ void HDText::drawMonsterHealthBar(d2::UnitAny* unit)
 	else if (*d2::screen_shift == SCREENPANEL_LEFT)
 		center = (float)(*d2::screen_width / 4 * 3);
 
-	const auto text_size = font->getTextSize(name);
+	const auto run = font->layoutText(name);
+	const auto text_size = run->size;
 	float hp_percent = (float)hp / (float)max_hp;
 
 	glm::vec2 bar_size = { 160.0f, 18.0f };
@@ -897,7 +927,7 @@ void HDText::drawMonsterHealthBar(d2::UnitAny* unit)
 		text_color = L'\x31';
 
 	glm::vec2 text_pos = { center - text_size.x / 2, bar_pos.y + 15.8f };
-	font->drawText(name, text_pos, g_text_colors.at(text_color));
+	font->drawText(*run, text_pos, g_text_colors.at(text_color));
 	m_hovered_unit.color = 0;
 
 	if (App.show_monster_res) {
@@ -921,8 +951,8 @@ void HDText::drawMonsterHealthBar(d2::UnitAny* unit)
 		font->setShadow(1);
 		font->setMasking(false);
 
-		const auto text_size = font->getTextSize(res_str);
-		font->drawText(res_str, { center - text_size.x / 2.0f, bar_pos.y - 3.0f }, g_text_colors.at(16));
+		const auto res_run = font->layoutText(res_str);
+		font->drawText(*res_run, { center - res_run->size.x / 2.0f, bar_pos.y - 3.0f }, g_text_colors.at(16));
 	}
 }
 
@@ -939,7 +969,8 @@ void HDText::drawPlayerHealthBar(d2::UnitAny* unit)
 	if (isVerMax(V_110) && unit->dwType == d2::UnitType::Player)
 		mbstowcs_s(nullptr, m_hovered_unit.name, d2::getPlayerName(unit), 16);
 	const wchar_t* name = unit->dwType == d2::UnitType::Player ? m_hovered_unit.name : d2::getMonsterName(unit);
-	const auto text_size = font->getTextSize(name);
+	const auto run = font->layoutText(name);
+	const auto text_size = run->size;
 	const float hp_percent = (float)hp / (float)max_hp;
 
 	glm::vec2 bar_size = { 60.0f, 16.0f };
@@ -964,7 +995,7 @@ void HDText::drawPlayerHealthBar(d2::UnitAny* unit)
 	}
 
 	glm::vec2 text_pos = { center - text_size.x / 2, bar_pos.y + 14.5f };
-	font->drawText(name, text_pos, g_text_colors.at(getColor(m_hovered_unit.color)));
+	font->drawText(*run, text_pos, g_text_colors.at(getColor(m_hovered_unit.color)));
 
 	m_hovered_unit.hp[0] = m_hovered_unit.hp[1] = 0;
 	m_hovered_unit.color = 0;
@@ -985,7 +1016,7 @@ void HDText::drawFpsCounter()
 	swprintf_s(str, L"FPS: %.0f", fps);
 
 	const auto old_size = HDText::Instance().getTextSize();
-	App.hd_text.active ? d2::setTextSizeHooked(19) : d2::setTextSizeHooked(6);
+	isActive() ? d2::setTextSizeHooked(19) : d2::setTextSizeHooked(6);
 	const auto width = d2::getNormalTextWidthHooked(str);
 	d2::drawNormalTextHooked(str, App.game.size.x / 2 - width / 2, App.game.size.y - 58, 4, 0);
 	d2::setTextSizeHooked(old_size);
@@ -1010,7 +1041,7 @@ void HDText::drawItemQuantity(bool draw, int x, int y)
 
 			const auto old_size = modules::HDText::Instance().getTextSize();
 			d2::setTextSizeHooked(6);
-			if (App.hd_text.active) {
+			if (isActive()) {
 				static auto bg = std::make_unique<Object>();
 				uint32_t width, height;
 
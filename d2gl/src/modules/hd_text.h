@@ -40,6 +40,8 @@ struct HoveredUnit {
 
 class HDText {
 	std::map<uint8_t, std::unique_ptr<Font>> m_fonts;
+	std::vector<GlyphSet*> m_glyph_sets;
+	bool m_loaded = false;
 	std::unique_ptr<Object> m_object_bg;
 	uint32_t m_lang_id = 0;
 	uint32_t m_text_size = 1;
@@ -78,7 +80,7 @@ public:
 		return instance;
 	}
 
-	inline bool isActive() { return App.hd_text.active; }
+	inline bool isActive() { return App.hd_text.active && m_loaded; }
 	inline void setMVP(const glm::mat4& mvp) { m_mvp = mvp; }
 
 	void reset();
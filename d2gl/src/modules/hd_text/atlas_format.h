@@ -0,0 +1,62 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <stdint.h>
+
+namespace d2gl {
+
+// Binary glyph atlas (data.bin), written by tools/atlas_packer:
+// AtlasHeader, AtlasPage[page_count], AtlasGlyph[glyph_count], page texels.
+#define ATLAS_MAGIC 0x41463244 // "D2FA"
+#define ATLAS_VERSION 1
+
+enum class AtlasPageFormat : uint32_t {
+	RGBA8,
+	Deflate,
+};
+
+#pragma pack(push, 1)
+struct AtlasHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t page_count;
+	uint32_t glyph_count;
+};
+
+struct AtlasPage {
+	uint32_t offset;
+	uint32_t size;
+	uint16_t width;
+	uint16_t height;
+	AtlasPageFormat format;
+};
+
+struct AtlasGlyph {
+	uint32_t code;
+	uint32_t page;
+	float advance;
+	float size[2];
+	float offset[2];
+	float tex_coord[4];
+};
+#pragma pack(pop)
+
+}
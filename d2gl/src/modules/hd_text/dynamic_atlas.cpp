@@ -0,0 +1,179 @@
+/*
+D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+Copyright (C) 2023  Bayaraa
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "dynamic_atlas.h"
+#include "layout_cache.h"
+
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imgui/imstb_truetype.h"
+
+namespace d2gl {
+
+struct FontFace {
+	AssetRef data;
+	stbtt_fontinfo info;
+	float scale = 1.0f;
+};
+
+DynamicAtlas::DynamicAtlas() = default;
+DynamicAtlas::~DynamicAtlas() = default;
+
+void DynamicAtlas::init(Texture* texture)
+{
+	m_texture = texture;
+	m_start_layer = texture->reserveLayers(DYNAMIC_ATLAS_PAGES);
+	m_cells_per_row = texture->getWidth() / DYNAMIC_ATLAS_CELL_SIZE;
+	m_cells_per_page = m_cells_per_row * (texture->getHeight() / DYNAMIC_ATLAS_CELL_SIZE);
+	m_slots.resize(m_cells_per_page * DYNAMIC_ATLAS_PAGES);
+}
+
+int DynamicAtlas::loadFont(const std::string& path)
+{
+	if (!m_texture)
+		return -1;
+
+	auto asset = AssetCache::Instance().load(path, true);
+	if (!asset)
+		return -1;
+
+	auto face = std::make_unique<FontFace>();
+	face->data = asset;
+	if (!stbtt_InitFont(&face->info, asset->getData(), stbtt_GetFontOffsetForIndex(asset->getData(), 0))) {
+		error_log("DynamicAtlas: Invalid font file (%s).", path.c_str());
+		return -1;
+	}
+	face->scale = stbtt_ScaleForMappingEmToPixels(&face->info, 32.0f);
+
+	m_faces.push_back(std::move(face));
+	return (int)m_faces.size() - 1;
+}
+
+int DynamicAtlas::findSlot()
+{
+	int oldest = -1;
+	for (size_t i = 0; i < m_slots.size(); i++) {
+		const auto& slot = m_slots[i];
+		if (!slot.owner)
+			return (int)i;
+
+		if (!slot.pending && m_frame - slot.last_used > DYNAMIC_ATLAS_MIN_AGE && (oldest < 0 || slot.last_used < m_slots[oldest].last_used))
+			oldest = (int)i;
+	}
+
+	if (oldest >= 0) {
+		auto& slot = m_slots[oldest];
+		slot.owner->removeGlyph(slot.code);
+		slot.owner = nullptr;
+		LayoutCache::Instance().clear();
+	}
+
+	return oldest;
+}
+
+bool DynamicAtlas::request(GlyphSet* owner, int face_id, wchar_t c)
+{
+	const uint64_t key = (uint64_t)face_id << 32 | (uint64_t)c;
+	if (m_pending.find(key) != m_pending.end())
+		return true;
+
+	const auto face = m_faces[face_id].get();
+	if (!stbtt_FindGlyphIndex(&face->info, c))
+		return false;
+
+	const int index = findSlot();
+	if (index < 0)
+		return false;
+
+	m_slots[index] = { owner, c, m_frame, true };
+	m_pending.insert({ key, (uint32_t)index });
+
+	const uint32_t layer = m_start_layer + index / m_cells_per_page;
+	const uint32_t cell_x = (index % m_cells_per_page) % m_cells_per_row * DYNAMIC_ATLAS_CELL_SIZE;
+	const uint32_t cell_y = (index % m_cells_per_page) / m_cells_per_row * DYNAMIC_ATLAS_CELL_SIZE;
+	const glm::vec2 texture_size = { (float)m_texture->getWidth(), (float)m_texture->getHeight() };
+
+	AssetLoader::Instance().run([this, face, c, index, layer, cell_x, cell_y, texture_size]() {
+		int width = 0, height = 0, offset_x = 0, offset_y = 0;
+		uint8_t* sdf = stbtt_GetCodepointSDF(&face->info, face->scale, c, DYNAMIC_ATLAS_PADDING, 128, 128.0f / DYNAMIC_ATLAS_PADDING, &width, &height, &offset_x, &offset_y);
+
+		int advance = 0, bearing = 0;
+		stbtt_GetCodepointHMetrics(&face->info, c, &advance, &bearing);
+
+		// The whole cell is uploaded so an evicted glyph never bleeds into linear filtering.
+		uint8_t* pixels = new uint8_t[DYNAMIC_ATLAS_CELL_SIZE * DYNAMIC_ATLAS_CELL_SIZE * 4]();
+		const int cell_width = glm::min(width, DYNAMIC_ATLAS_CELL_SIZE);
+		const int cell_height = glm::min(height, DYNAMIC_ATLAS_CELL_SIZE);
+		for (int y = 0; y < cell_height; y++) {
+			for (int x = 0; x < cell_width; x++)
+				memset(pixels + (y * DYNAMIC_ATLAS_CELL_SIZE + x) * 4, sdf[y * width + x], 4);
+		}
+		stbtt_FreeSDF(sdf, nullptr);
+
+		Glyph glyph;
+		glyph.advance = advance * face->scale;
+		glyph.size = { (float)cell_width, (float)cell_height };
+		glyph.offset = { (float)offset_x, (float)offset_y };
+		glyph.tex_id = (uint16_t)layer;
+		glyph.tex_coord = glm::vec4(cell_x, cell_y + cell_height, cell_x + cell_width, cell_y) / glm::vec4(texture_size, texture_size);
+		glyph.slot = (uint16_t)(index + 1);
+
+		AssetLoader::Instance().upload([this, pixels, layer, cell_x, cell_y, index, glyph]() {
+			m_texture->fill(pixels, DYNAMIC_ATLAS_CELL_SIZE, DYNAMIC_ATLAS_CELL_SIZE, cell_x, cell_y, layer);
+			delete[] pixels;
+
+			std::lock_guard<std::mutex> lock(m_completed_mutex);
+			m_completed.push_back({ (uint32_t)index, glyph });
+		});
+	});
+
+	return true;
+}
+
+void DynamicAtlas::update()
+{
+	m_frame++;
+
+	std::vector<Completed> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_completed_mutex);
+		completed.swap(m_completed);
+	}
+	if (completed.empty())
+		return;
+
+	for (auto& item : completed) {
+		auto& slot = m_slots[item.slot];
+		slot.pending = false;
+		slot.last_used = m_frame;
+		slot.owner->addGlyph(slot.code, item.glyph);
+	}
+	std::erase_if(m_pending, [this](const auto& item) { return !m_slots[item.second].pending; });
+
+	// Layouts built while these glyphs were missing used the fallback glyph.
+	LayoutCache::Instance().clear();
+}
+
+bool DynamicAtlas::hasFont(const std::string& path)
+{
+	return AssetCache::Instance().load(path, true) != nullptr;
+}
+
+}
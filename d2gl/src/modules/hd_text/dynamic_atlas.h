@@ -0,0 +1,81 @@
+/*
+D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+Copyright (C) 2023  Bayaraa
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "glyph_set.h"
+
+namespace d2gl {
+
+#define DYNAMIC_ATLAS_PAGES 2
+#define DYNAMIC_ATLAS_CELL_SIZE 64
+#define DYNAMIC_ATLAS_PADDING 4
+#define DYNAMIC_ATLAS_MIN_AGE 60
+
+struct FontFace;
+
+class DynamicAtlas {
+	struct Slot {
+		GlyphSet* owner = nullptr;
+		wchar_t code = 0;
+		uint32_t last_used = 0;
+		bool pending = false;
+	};
+
+	struct Completed {
+		uint32_t slot;
+		Glyph glyph;
+	};
+
+	Texture* m_texture = nullptr;
+	uint32_t m_start_layer = 0;
+	uint32_t m_cells_per_row = 0;
+	uint32_t m_cells_per_page = 0;
+	std::vector<Slot> m_slots;
+	std::vector<std::unique_ptr<FontFace>> m_faces;
+	std::unordered_map<uint64_t, uint32_t> m_pending;
+	uint32_t m_frame = 0;
+
+	std::vector<Completed> m_completed;
+	std::mutex m_completed_mutex;
+
+	DynamicAtlas();
+	~DynamicAtlas();
+
+	int findSlot();
+
+public:
+	static DynamicAtlas& Instance()
+	{
+		static DynamicAtlas instance;
+		return instance;
+	}
+
+	void init(Texture* texture);
+	int loadFont(const std::string& path);
+
+	bool request(GlyphSet* owner, int face, wchar_t c);
+	inline void touch(uint32_t slot) { m_slots[slot].last_used = m_frame; }
+	void update();
+
+	inline bool isActive() { return m_texture != nullptr; }
+	static bool hasFont(const std::string& path);
+};
+
+}
@@ -18,157 +18,193 @@
 
 #include "pch.h"
 #include "font.h"
+#include "dynamic_atlas.h"
 #include "helpers.h"
 
 namespace d2gl {
 
+namespace {
+
+uint32_t g_font_count = 0;
+
+}
+
 Font::Font(GlyphSet* glyph_set, const FontCreateInfo& font_ci)
 	: m_glyph_set(glyph_set), m_name(font_ci.name), m_size(font_ci.size), m_weight(font_ci.weight), m_letter_spacing(font_ci.letter_spacing), m_line_height(font_ci.line_height),
 	  m_shadow_intensity(font_ci.shadow_intensity), m_offset(font_ci.offset), m_symbol_offset(font_ci.symbol_offset), m_color(font_ci.color), m_bordered(font_ci.bordered)
 {
+	m_id = ++g_font_count;
 	setSize();
-	m_object = std::make_unique<Object>();
+	m_quad.rect = { 0, 0, 0, 0 };
+	m_quad.color1 = 0xFFFFFFFF;
+	m_quad.color2 = 0xFFFFFFFF;
 }
 
-glm::vec2 Font::getTextSize(const wchar_t* str, const int max_chars)
+std::shared_ptr<const TextRun> Font::layoutText(const wchar_t* str, const int max_chars)
 {
-	m_text_size = { 0.0f, 0.0f };
+	auto& cache = LayoutCache::Instance();
+	uint64_t key = LayoutCache::combine(LayoutCache::hashString(str), m_id);
+	key = LayoutCache::combine(key, ((uint64_t)m_generation << 32) | (uint32_t)max_chars);
+
+	if (auto run = cache.findRun(key, str, m_id, m_generation, max_chars))
+		return run;
+
+	auto run = std::make_shared<TextRun>();
+	run->id = cache.newRunId();
+	run->text = str;
+	run->font_id = m_id;
+	run->generation = m_generation;
+	run->max_chars = max_chars;
 	const float line_height = getLineHeight();
 	const float letter_spacing = getLetterSpacing();
 
 	float advance = 0.0f;
+	float pen = 0.0f;
+	wchar_t color = 0;
 	int char_num = 0;
-	int line_num = 0;
 
 	while (str[char_num] != L'\0') {
 		if (str[char_num] == L'ÿ' && str[char_num + 1] == L'c') {
 			const auto color_code = str[char_num + 2];
 			if (g_text_colors.find(color_code) != g_text_colors.end()) {
+				color = color_code;
 				char_num += 3;
 				continue;
 			}
 		}
 		if (str[char_num] == L'\n') {
-			m_line_width[line_num] = advance;
-			m_text_size.x = glm::max(m_text_size.x, advance);
+			run->size.x = glm::max(run->size.x, advance);
 			if (str[char_num + 1] != L'\0') {
-				m_text_size.y += line_height;
+				run->line_widths.push_back(advance);
+				run->size.y += line_height;
 				advance = 0.0f;
-				line_num++;
+				pen = 0.0f;
+			}
+		} else {
+			const auto entry = m_glyph_set->getGlyph(str[char_num]);
+			if (auto glyph = entry.glyph) {
+				if (str[char_num] != L' ')
+					run->glyphs.push_back({ glyph, pen, (uint32_t)run->line_widths.size(), color, entry.symbol });
+
+				advance += glyph->advance * m_scale;
+				pen += glyph->advance * m_scale;
+				if (str[char_num + 1] != L'\n' && str[char_num + 1] != L'\0')
+					advance += letter_spacing;
 			}
-		} else if (auto glyph = m_glyph_set->getGlyph(str[char_num])) {
-			advance += glyph->advance * m_scale;
-			if (str[char_num + 1] != L'\n' && str[char_num + 1] != L'\0')
-				advance += letter_spacing;
+			pen += letter_spacing;
 		}
 		if (max_chars > 0 && max_chars < char_num)
 			break;
 		char_num++;
 	}
 
-	m_line_count = line_num + 1;
-	m_line_width[line_num] = advance;
-	m_text_size.x = glm::max(m_text_size.x, advance);
-	m_text_size.y += line_height - (line_height - m_font_size);
+	run->line_widths.push_back(advance);
+	run->line_count = (uint32_t)run->line_widths.size();
+	run->size.x = glm::max(run->size.x, advance);
+	run->size.y += line_height - (line_height - m_font_size);
+
+	cache.storeRun(key, run);
+
+	return run;
+}
+
+void Font::drawText(const TextRun& run, glm::vec2 pos, uint32_t color, bool framed)
+{
+	auto& cache = LayoutCache::Instance();
+	const uint32_t flags = (uint32_t)framed | (uint32_t)m_align << 8 | (uint32_t)m_shadow_level << 16 | (uint32_t)m_masking << 24;
+	uint64_t key = LayoutCache::combine(run.id, color);
+	key = LayoutCache::combine(key, flags);
+	key = LayoutCache::combineFloat(key, m_opacity);
+
+	auto layout = cache.findLayout(key, run.id, color, flags, m_opacity);
+	if (!layout) {
+		auto new_layout = buildLayout(run, color, framed);
+		new_layout.run_id = run.id;
+		new_layout.color = color;
+		new_layout.flags = flags;
+		new_layout.opacity = m_opacity;
+		layout = cache.storeLayout(key, std::move(new_layout));
+	}
+
+	for (auto slot : layout->slots)
+		DynamicAtlas::Instance().touch(slot);
 
-	return m_text_size;
+	cache.pushLayout(*layout, pos);
 }
 
-void Font::drawText(const wchar_t* str, glm::vec2 pos, uint32_t color, bool framed)
+TextLayout Font::buildLayout(const TextRun& run, uint32_t color, bool framed)
 {
+	TextLayout layout;
 	const auto line_height = getLineHeight();
-	const auto letter_spacing = getLetterSpacing();
-	auto text_offset = getTextOffset();
 
-	glm::vec2 offset = text_offset;
+	auto text_offset = getTextOffset();
 	if (framed) {
-		offset.x = text_offset.x = 0.0f;
-		offset.y += (float)m_line_count * line_height - line_height;
+		text_offset.x = 0.0f;
+		text_offset.y += (float)run.line_count * line_height - line_height;
 	} else
-		offset.y += (m_font_size - m_size) / 2.0f;
+		text_offset.y += (m_font_size - m_size) / 2.0f;
 
-	if (m_align == TextAlign::Right)
-		offset.x += m_text_size.x - m_line_width[0];
-	else if (m_align == TextAlign::Center)
-		offset.x += (m_text_size.x - m_line_width[0]) / 2.0f;
-
-	uint32_t char_color = color;
 	if (m_bordered) {
 		uint32_t border_color = 0x443B29FF;
 		if (color == 0xC22121FF)
 			border_color = 0x4A1515FF;
 		else if (color == 0xDFB67966)
 			border_color = 0x443B2966;
-		m_object->setColor(border_color, 2);
+		m_quad.color2 = border_color;
 	} else {
 		uint32_t color2 = 0xFFFFFFFF;
 		uint8_t* opacity = (uint8_t*)&color2;
 		*opacity = (uint8_t)(255.0f * m_opacity);
-		m_object->setColor(color2, 2);
+		m_quad.color2 = color2;
 	}
 
-	int char_num = 0;
-	int line_num = 0;
-	while (str[char_num] != L'\0') {
-		if (str[char_num] == L'ÿ' && str[char_num + 1] == L'c') {
-			const auto color_code = str[char_num + 2];
-			if (g_text_colors.find(color_code) != g_text_colors.end()) {
-				char_color = g_text_colors.at(color_code);
-				char_num += 3;
-				continue;
-			}
-		}
-		if (str[char_num] == L'\n') {
-			offset.x = text_offset.x;
-			offset.y -= line_height;
-
-			if (str[char_num + 1] == L'\0')
-				break;
-			line_num++;
-
-			if (m_align == TextAlign::Right)
-				offset.x += m_text_size.x - m_line_width[line_num];
-			else if (m_align == TextAlign::Center)
-				offset.x += (m_text_size.x - m_line_width[line_num]) / 2.0f;
-		} else
-			offset.x += drawChar(str[char_num], pos + offset, char_color) + letter_spacing;
-		char_num++;
+	layout.quads.reserve(run.glyphs.size() * (m_shadow_level > 0 ? 2 : 1));
+	layout.bounds.reserve(layout.quads.capacity());
+
+	for (const auto& item : run.glyphs) {
+		glm::vec2 offset = { text_offset.x + item.x, text_offset.y - (float)item.line * line_height };
+		if (m_align == TextAlign::Right)
+			offset.x += run.size.x - run.line_widths[item.line];
+		else if (m_align == TextAlign::Center)
+			offset.x += (run.size.x - run.line_widths[item.line]) / 2.0f;
+
+		drawChar(item, offset, item.color ? g_text_colors.at(item.color) : color, layout);
 	}
-	m_line_count = 0;
+
+	return layout;
 }
 
-float Font::drawChar(wchar_t c, glm::vec2 pos, uint32_t color)
+void Font::drawChar(const TextGlyph& item, glm::vec2 pos, uint32_t color, TextLayout& layout)
 {
-	if (auto glyph = m_glyph_set->getGlyph(c)) {
-		if (c == L' ')
-			return glyph->advance * m_scale;
-
-		glm::vec2 object_pos = pos + glyph->offset * m_scale;
-		float weight = m_weight;
-		if (m_glyph_set->isSymbol()) {
-			object_pos.y += m_font_size * m_symbol_offset;
-			weight = 1.0f + ((m_weight - 1.0f) * 0.5f);
-		}
+	const auto glyph = item.glyph;
+	glm::vec2 object_pos = pos + glyph->offset * m_scale;
+	float weight = m_weight;
+	if (item.symbol) {
+		object_pos.y += m_font_size * m_symbol_offset;
+		weight = 1.0f + ((m_weight - 1.0f) * 0.5f);
+	}
 
-		m_object->setSize(glyph->size * m_scale);
-		m_object->setTexIds({ glyph->tex_id, 0 });
-		m_object->setTexCoord(glyph->tex_coord);
-		m_object->setPosition(object_pos);
-		m_object->setColor(color);
+	m_quad.color1 = color;
+	m_quad.tex_ids = { glyph->tex_id, 0 };
+	if (glyph->slot)
+		layout.slots.push_back(glyph->slot - 1);
 
-		if (m_shadow_level > 0) {
-			m_object->setExtra({ m_shadow_intensity, 0.0f });
-			m_object->setFlags(3, m_shadow_level, m_masking);
-			App.context->pushObject(m_object);
-		}
-		m_object->setExtra({ m_smoothness, weight });
-		m_object->setFlags(3, 0, m_masking, m_bordered);
-		App.context->pushObject(m_object);
-
-		return glyph->advance * m_scale;
+	if (m_shadow_level > 0) {
+		m_quad.extra = { glm::detail::toFloat16(m_shadow_intensity), 0 };
+		m_quad.flags = { 3, m_shadow_level, m_masking, 0 };
+		pushQuad(layout, glyph, object_pos);
 	}
+	m_quad.extra = { glm::detail::toFloat16(m_smoothness), glm::detail::toFloat16(weight) };
+	m_quad.flags = { 3, 0, m_masking, m_bordered };
+	pushQuad(layout, glyph, object_pos);
+}
+
+void Font::pushQuad(TextLayout& layout, const Glyph* glyph, glm::vec2 pos)
+{
+	m_quad.tex_rect = QuadMod::toTexRect(glyph->tex_coord);
 
-	return 0.0f;
+	layout.quads.push_back(m_quad);
+	layout.bounds.push_back({ pos, pos + glyph->size * m_scale });
 }
 
 #ifdef _HDTEXT
@@ -19,6 +19,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #pragma once
 
 #include "glyph_set.h"
+#include "layout_cache.h"
 #include "variables.h"
 
 namespace d2gl {
@@ -37,7 +38,7 @@ struct FontCreateInfo {
 };
 
 class Font {
-	std::unique_ptr<Object> m_object;
+	QuadMod m_quad;
 	GlyphSet* m_glyph_set = nullptr;
 	std::string m_name;
 	float m_scale = 1.0f;
@@ -56,19 +57,17 @@ class Font {
 
 	float m_smoothness = 5.0f;
 	uint8_t m_shadow_level = 0;
+	uint32_t m_generation = 0;
+	uint32_t m_id = 0;
 
 	TextAlign m_align = TextAlign::Left;
-	float m_line_width[100] = { 0.0f };
-	glm::vec2 m_text_size = { 0.0f, 0.0f };
-
-	uint32_t m_line_count = 0;
 	bool m_masking = false;
 
 public:
 	Font(GlyphSet* glyph_set, const FontCreateInfo& font_ci);
 	~Font() = default;
 
-	inline void setSize() { m_font_size = m_size * App.hd_text.scale.value, m_scale = m_font_size / 32.0f, m_smoothness = m_font_size; }
+	inline void setSize() { m_font_size = m_size * App.hd_text.scale.value, m_scale = m_font_size / 32.0f, m_smoothness = m_font_size, m_generation++; }
 	inline void setAlign(TextAlign align) { m_align = align; }
 	inline void setShadow(uint8_t level = 0) { m_shadow_level = level; }
 	inline void setMasking(bool masking) { m_masking = masking; }
@@ -80,13 +79,17 @@ public:
 	inline float getLineHeight() { return m_font_size * m_line_height; }
 	inline float getLetterSpacing() { return m_font_size * m_letter_spacing; }
 	inline glm::vec2 getTextOffset() { return m_font_size * m_offset; }
-	inline int getLineCount() { return m_line_count; }
 
-	glm::vec2 getTextSize(const wchar_t* str, const int max_chars = 0);
-	void drawText(const wchar_t* str, glm::vec2 pos, uint32_t color, bool framed = false);
+	std::shared_ptr<const TextRun> layoutText(const wchar_t* str, const int max_chars = 0);
+	inline glm::vec2 getTextSize(const wchar_t* str, const int max_chars = 0) { return layoutText(str, max_chars)->size; }
+
+	void drawText(const TextRun& run, glm::vec2 pos, uint32_t color, bool framed = false);
+	inline void drawText(const wchar_t* str, glm::vec2 pos, uint32_t color, bool framed = false) { drawText(*layoutText(str), pos, color, framed); }
 
 private:
-	float drawChar(wchar_t c, glm::vec2 pos, uint32_t color);
+	TextLayout buildLayout(const TextRun& run, uint32_t color, bool framed);
+	void drawChar(const TextGlyph& item, glm::vec2 pos, uint32_t color, TextLayout& layout);
+	void pushQuad(TextLayout& layout, const Glyph* glyph, glm::vec2 pos);
 
 #ifdef _HDTEXT
 public:
@@ -18,69 +18,255 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "pch.h"
 #include "glyph_set.h"
+#include "asset_cache.h"
+#include "atlas_format.h"
+#include "dynamic_atlas.h"
 #include "helpers.h"
 
+#include "stb/stb_image.h"
+
 namespace d2gl {
 
+namespace {
+
+// data.bin is checked once per atlas when its pages are counted, the glyph set then loads the same source.
+std::unordered_map<std::string, AssetRef> g_atlases;
+
+}
+
 GlyphSet::GlyphSet(Texture* texture, const std::string& name, GlyphSet* symbol_set)
-	: m_symbols(symbol_set ? symbol_set->getGlyphes() : nullptr)
+	: m_symbol_set(symbol_set)
+{
+	const std::string path = "assets\\atlases\\" + name + "\\";
+	m_face = DynamicAtlas::Instance().loadFont(path + "font.ttf");
+
+	if (auto atlas = findAtlas(name, { texture->getWidth(), texture->getHeight() }))
+		loadAtlas(texture, atlas);
+	else
+		loadCSV(texture, path, m_face >= 0);
+	g_atlases.erase(name);
+}
+
+uint32_t GlyphSet::getPageCount(const std::string& name, glm::uvec2 texture_size)
 {
-	auto buffer = helpers::loadFile("assets\\atlases\\" + name + "\\data.csv");
-	if (!buffer.size)
+	if (auto atlas = findAtlas(name, texture_size))
+		return ((const AtlasHeader*)atlas->getData())->page_count;
+
+	const std::string path = "assets\\atlases\\" + name + "\\";
+
+	auto csv = AssetCache::Instance().load(path + "data.csv", hasFont(name));
+	if (!csv)
+		return 0;
+
+	auto pos = (csv->getData() + (csv->getSize() - 5));
+	while (*pos != '\n' || pos == csv->getData())
+		pos--;
+	std::string num = std::string((const char*)(pos + 1), 2);
+	helpers::replaceAll(num, ",", "");
+
+	return std::atoi(num.c_str()) + 1;
+}
+
+bool GlyphSet::hasFont(const std::string& name)
+{
+	return DynamicAtlas::hasFont("assets\\atlases\\" + name + "\\font.ttf");
+}
+
+AssetRef GlyphSet::findAtlas(const std::string& name, glm::uvec2 texture_size)
+{
+	if (auto it = g_atlases.find(name); it != g_atlases.end())
+		return it->second;
+
+	auto atlas = AssetCache::Instance().load("assets\\atlases\\" + name + "\\data.bin", true);
+	if (atlas && !checkAtlas(atlas, texture_size))
+		atlas = nullptr;
+
+	g_atlases[name] = atlas;
+	return atlas;
+}
+
+bool GlyphSet::checkAtlas(const AssetRef& atlas, glm::uvec2 texture_size)
+{
+	const auto data = atlas->getData();
+	const size_t size = atlas->getSize();
+	if (size < sizeof(AtlasHeader)) {
+		error_log("GlyphSet: Invalid atlas header.");
+		return false;
+	}
+
+	const auto header = (const AtlasHeader*)data;
+	const uint64_t table_size = sizeof(AtlasHeader) + (uint64_t)header->page_count * sizeof(AtlasPage) + (uint64_t)header->glyph_count * sizeof(AtlasGlyph);
+	if (header->magic != ATLAS_MAGIC || header->version != ATLAS_VERSION || table_size > size) {
+		error_log("GlyphSet: Invalid atlas header.");
+		return false;
+	}
+
+	const auto pages = (const AtlasPage*)(data + sizeof(AtlasHeader));
+	const auto glyphs = (const AtlasGlyph*)(pages + header->page_count);
+
+	for (uint32_t i = 0; i < header->page_count; i++) {
+		const auto& page = pages[i];
+		const bool valid_size = page.width <= texture_size.x && page.height <= texture_size.y && (page.format == AtlasPageFormat::Deflate || page.size == (uint32_t)page.width * page.height * 4);
+		if ((uint64_t)page.offset + page.size > size || !valid_size || page.format > AtlasPageFormat::Deflate) {
+			error_log("GlyphSet: Invalid atlas page %d.", i);
+			return false;
+		}
+	}
+
+	for (uint32_t i = 0; i < header->glyph_count; i++) {
+		if (glyphs[i].page >= header->page_count) {
+			error_log("GlyphSet: Invalid atlas glyph %d.", i);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void GlyphSet::loadAtlas(Texture* texture, const AssetRef& atlas)
+{
+	const auto data = atlas->getData();
+	const auto header = (const AtlasHeader*)data;
+	const auto pages = (const AtlasPage*)(data + sizeof(AtlasHeader));
+	const auto glyphs = (const AtlasGlyph*)(pages + header->page_count);
+
+	const uint32_t start_layer = texture->reserveLayers(header->page_count);
+	for (uint32_t i = 0; i < header->page_count; i++) {
+		const auto page = pages[i];
+		const auto texels = data + page.offset;
+		const uint32_t layer = start_layer + i;
+
+		m_pending++;
+		if (page.format == AtlasPageFormat::RGBA8) {
+			AssetLoader::Instance().upload([this, texture, atlas, page, texels, layer]() {
+				texture->fill(texels, page.width, page.height, 0, 0, layer);
+				m_pending--;
+			});
+			continue;
+		}
+
+		AssetLoader::Instance().run([this, texture, atlas, page, texels, layer]() {
+			const int pixels_size = (int)page.width * page.height * 4;
+			uint8_t* pixels = new uint8_t[pixels_size];
+			if (stbi_zlib_decode_buffer((char*)pixels, pixels_size, (const char*)texels, page.size) != pixels_size) {
+				error_log("GlyphSet: Atlas page %d decompress error.", layer);
+				delete[] pixels;
+				pixels = nullptr;
+			}
+
+			AssetLoader::Instance().upload([this, texture, page, pixels, layer]() {
+				if (pixels)
+					texture->fill(pixels, page.width, page.height, 0, 0, layer);
+				delete[] pixels;
+				m_pending--;
+			});
+		});
+	}
+
+	for (uint32_t i = 0; i < header->glyph_count; i++) {
+		const auto& glyph = glyphs[i];
+		auto& dst = insert((wchar_t)glyph.code);
+		dst.advance = glyph.advance;
+		dst.size = { glyph.size[0], glyph.size[1] };
+		dst.offset = { glyph.offset[0], glyph.offset[1] };
+		dst.tex_id = start_layer + glyph.page;
+		dst.tex_coord = { glyph.tex_coord[0], glyph.tex_coord[1], glyph.tex_coord[2], glyph.tex_coord[3] };
+	}
+}
+
+void GlyphSet::loadCSV(Texture* texture, const std::string& path, bool optional)
+{
+	auto asset = AssetCache::Instance().load(path + "data.csv", optional);
+	if (!asset)
 		return;
 
 	int atlas_index = -1;
 	uint32_t start_layer = 0;
-	std::string data((const char*)buffer.data, buffer.size);
-	auto lines = helpers::strToLines(data);
-	delete[] buffer.data;
+	auto lines = helpers::strToLines(asset->getString());
 
 	for (auto& line : lines) {
 		auto cols = helpers::splitToVector(line);
 
 		auto index = std::atoi(cols[0].c_str());
 		if (atlas_index < index) {
-			auto image_data = helpers::loadImage("assets\\atlases\\" + name + "\\" + cols[0] + ".png");
-			auto tex_data = texture->fillImage(image_data);
-			helpers::clearImage(image_data);
-			start_layer = tex_data.start_layer;
+			start_layer = texture->reserveLayers(1);
 			atlas_index = index;
+
+			m_pending++;
+			AssetLoader::Instance().loadImage(path + cols[0] + ".png", true, [this, texture, start_layer](const ImageData& image) {
+				if (image.data)
+					texture->fillLayers(image, start_layer);
+				m_pending--;
+			});
 		}
 
 		wchar_t cc = (wchar_t)std::atoi(cols[1].c_str());
 		glm::vec4 coords = { std::stof(cols[7]), std::stof(cols[8]), std::stof(cols[9]), std::stof(cols[10]) };
 		glm::vec4 bounds = { std::stof(cols[3]), std::stof(cols[4]), std::stof(cols[5]), std::stof(cols[6]) };
 
-		m_glyphes[cc].advance = std::stof(cols[2].c_str()) * 32.0f;
-		m_glyphes[cc].size = { coords.z - coords.x, coords.w - coords.y };
-		m_glyphes[cc].offset = { bounds.x * 32.0f, -bounds.w * 32.0f };
-		m_glyphes[cc].tex_id = start_layer;
-		m_glyphes[cc].tex_coord = coords / 1024.0f;
+		auto& glyph = insert(cc);
+		glyph.advance = std::stof(cols[2].c_str()) * 32.0f;
+		glyph.size = { coords.z - coords.x, coords.w - coords.y };
+		glyph.offset = { bounds.x * 32.0f, -bounds.w * 32.0f };
+		glyph.tex_id = start_layer;
+		glyph.tex_coord = coords / 1024.0f;
 	}
 }
 
-const Glyph* GlyphSet::getGlyph(wchar_t c)
+Glyph& GlyphSet::insert(wchar_t c)
+{
+	auto& page = m_pages[(c >> 8) & 0xFF];
+	if (!page)
+		page = std::make_unique<GlyphPage>();
+
+	page->present.set(c & 0xFF);
+	return page->glyphs[c & 0xFF];
+}
+
+void GlyphSet::addGlyph(wchar_t c, const Glyph& glyph)
+{
+	insert(c) = glyph;
+}
+
+void GlyphSet::removeGlyph(wchar_t c)
 {
-	m_is_symbol = false;
-	if (m_glyphes.find(c) != m_glyphes.end())
-		return &m_glyphes[c];
+	if (auto& page = m_pages[(c >> 8) & 0xFF])
+		page->present.reset(c & 0xFF);
+}
+
+GlyphEntry GlyphSet::getGlyph(wchar_t c)
+{
+	static const Glyph empty_glyph;
 
-	if (c == L'\xa0')
-		return &m_glyphes[L' '];
+	if (auto glyph = find(c)) {
+		if (glyph->slot)
+			DynamicAtlas::Instance().touch(glyph->slot - 1);
+		return { glyph, false };
+	}
 
-	if (m_symbols) {
-		m_is_symbol = true;
-		if (m_symbols->find(c) != m_symbols->end())
-			return &m_symbols->at(c);
+	if (c == L'\xa0') {
+		auto glyph = find(L' ');
+		return { glyph ? glyph : &empty_glyph, false };
+	}
 
-		if (c > 0x20)
-			return &m_symbols->at(L'☹');
+	if (m_symbol_set) {
+		if (auto glyph = m_symbol_set->find(c))
+			return { glyph, true };
 	}
 
-	if (c > 0x20)
-		return &m_glyphes[L'?'];
+	// Missing glyphs fall back until the dynamic atlas has rasterized them.
+	if (m_face >= 0 && c > 0x20)
+		DynamicAtlas::Instance().request(this, m_face, c);
+
+	if (m_symbol_set)
+		return { c > 0x20 ? m_symbol_set->find(L'☹') : nullptr, true };
+
+	if (c > 0x20) {
+		auto glyph = find(L'?');
+		return { glyph ? glyph : &empty_glyph, false };
+	}
 
-	return nullptr;
+	return {};
 }
 
 }
\ No newline at end of file
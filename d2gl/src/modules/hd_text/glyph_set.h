@@ -18,6 +18,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #pragma once
 
+#include "asset_cache.h"
+
 namespace d2gl {
 
 struct Glyph {
@@ -25,21 +27,51 @@ struct Glyph {
 	glm::vec2 offset = { 0.0f, 0.0f };
 	float advance = 0.0f;
 	uint16_t tex_id = 0;
+	uint16_t slot = 0;
 	glm::vec4 tex_coord = { 0.0f, 0.0f, 0.0f, 0.0f };
 };
 
+struct GlyphEntry {
+	const Glyph* glyph = nullptr;
+	bool symbol = false;
+};
+
 class GlyphSet {
-	std::map<wchar_t, Glyph> m_glyphes;
-	std::map<wchar_t, Glyph>* m_symbols = nullptr;
-	bool m_is_symbol = false;
+	struct GlyphPage {
+		std::array<Glyph, 256> glyphs;
+		std::bitset<256> present;
+	};
+
+	std::array<std::unique_ptr<GlyphPage>, 256> m_pages;
+	GlyphSet* m_symbol_set = nullptr;
+	std::atomic<uint32_t> m_pending = 0;
+	int m_face = -1;
+
+	Glyph& insert(wchar_t c);
+	void loadAtlas(Texture* texture, const AssetRef& atlas);
+	void loadCSV(Texture* texture, const std::string& path, bool optional);
 
 public:
 	GlyphSet(Texture* texture, const std::string& name, GlyphSet* symbol_set = nullptr);
 	~GlyphSet() = default;
 
-	const Glyph* getGlyph(wchar_t c);
-	inline bool isSymbol() { return m_is_symbol; }
-	inline std::map<wchar_t, Glyph>* getGlyphes() { return &m_glyphes; }
+	GlyphEntry getGlyph(wchar_t c);
+	void addGlyph(wchar_t c, const Glyph& glyph);
+	void removeGlyph(wchar_t c);
+	inline bool isReady() { return m_pending == 0; }
+
+	inline const Glyph* find(wchar_t c) const
+	{
+		const auto& page = m_pages[(c >> 8) & 0xFF];
+		return page && page->present[c & 0xFF] ? &page->glyphs[c & 0xFF] : nullptr;
+	}
+
+	static uint32_t getPageCount(const std::string& name, glm::uvec2 texture_size);
+	static bool hasFont(const std::string& name);
+
+private:
+	static AssetRef findAtlas(const std::string& name, glm::uvec2 texture_size);
+	static bool checkAtlas(const AssetRef& atlas, glm::uvec2 texture_size);
 };
 
 }
\ No newline at end of file
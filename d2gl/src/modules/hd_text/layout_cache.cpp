@@ -0,0 +1,207 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "layout_cache.h"
+
+#include <intrin.h>
+#include <immintrin.h>
+
+namespace d2gl {
+
+namespace {
+
+bool detectF16C()
+{
+	int info[4] = { 0 };
+	__cpuid(info, 1);
+	const bool osxsave = info[2] & (1 << 27);
+	const bool avx = info[2] & (1 << 28);
+	const bool f16c = info[2] & (1 << 29);
+
+	return osxsave && avx && f16c && (_xgetbv(0) & 6) == 6;
+}
+
+const bool g_f16c = detectF16C();
+
+// Bounds are x0, y0, x1, y1 of each quad relative to the layout origin, the same layout as QuadMod::rect.
+void writeRectsF16C(QuadMod* quads, const glm::vec4* bounds, size_t count, glm::vec2 pos)
+{
+	const __m128 offset = _mm_setr_ps(pos.x, pos.y, pos.x, pos.y);
+
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		const __m128 a = _mm_add_ps(_mm_loadu_ps(&bounds[i].x), offset);
+		const __m128 b = _mm_add_ps(_mm_loadu_ps(&bounds[i + 1].x), offset);
+		_mm_storel_epi64((__m128i*)&quads[i].rect, _mm_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT));
+		_mm_storel_epi64((__m128i*)&quads[i + 1].rect, _mm_cvtps_ph(b, _MM_FROUND_TO_NEAREST_INT));
+	}
+	if (i < count) {
+		const __m128 a = _mm_add_ps(_mm_loadu_ps(&bounds[i].x), offset);
+		_mm_storel_epi64((__m128i*)&quads[i].rect, _mm_cvtps_ph(a, _MM_FROUND_TO_NEAREST_INT));
+	}
+}
+
+// Rounds ties to even like _mm_cvtps_ph, glm::detail::toFloat16 rounds them up and the two paths would disagree by one ulp.
+int16_t toHalf(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const uint32_t sign = (bits >> 16) & 0x8000;
+	const uint32_t abs = bits & 0x7FFFFFFF;
+
+	if (abs >= 0x7F800000)
+		return (int16_t)(sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 | ((abs >> 13) & 0x3FF) : 0));
+	if (abs >= 0x477FF000)
+		return (int16_t)(sign | 0x7C00);
+
+	uint32_t mantissa;
+	uint32_t shift;
+	if (abs >= 0x38800000) {
+		mantissa = abs - 0x38000000;
+		shift = 13;
+	} else {
+		if (abs < 0x33000000)
+			return (int16_t)sign;
+		const uint32_t exponent = abs >> 23;
+		mantissa = (abs & 0x7FFFFF) | 0x800000;
+		shift = 126 - exponent;
+	}
+
+	const uint32_t half = 1u << (shift - 1);
+	const uint32_t rest = mantissa & ((1u << shift) - 1);
+	uint32_t result = mantissa >> shift;
+	if (rest > half || (rest == half && (result & 1)))
+		result++;
+
+	return (int16_t)(sign | result);
+}
+
+void writeRects(QuadMod* quads, const glm::vec4* bounds, size_t count, glm::vec2 pos)
+{
+	for (size_t i = 0; i < count; i++) {
+		quads[i].rect.x = toHalf(pos.x + bounds[i].x);
+		quads[i].rect.y = toHalf(pos.y + bounds[i].y);
+		quads[i].rect.z = toHalf(pos.x + bounds[i].z);
+		quads[i].rect.w = toHalf(pos.y + bounds[i].w);
+	}
+}
+
+}
+
+std::shared_ptr<const TextRun> LayoutCache::findRun(uint64_t key, const wchar_t* str, uint32_t font_id, uint32_t generation, int max_chars)
+{
+	auto it = m_runs.find(key);
+	if (it == m_runs.end()) {
+		m_stats.misses++;
+		return nullptr;
+	}
+
+	const auto& run = *it->second.value;
+	if (run.font_id != font_id || run.generation != generation || run.max_chars != max_chars || run.text != str) {
+		m_stats.misses++;
+		return nullptr;
+	}
+
+	m_stats.hits++;
+	it->second.last_frame = m_frame;
+	return it->second.value;
+}
+
+void LayoutCache::storeRun(uint64_t key, const std::shared_ptr<const TextRun>& run)
+{
+	if (m_runs.size() >= LAYOUT_CACHE_MAX_ENTRIES)
+		m_runs.clear();
+
+	m_runs[key] = { run, m_frame };
+}
+
+const TextLayout* LayoutCache::findLayout(uint64_t key, uint64_t run_id, uint32_t color, uint32_t flags, float opacity)
+{
+	auto it = m_layouts.find(key);
+	if (it == m_layouts.end()) {
+		m_stats.misses++;
+		return nullptr;
+	}
+
+	const auto& layout = it->second.value;
+	if (layout.run_id != run_id || layout.color != color || layout.flags != flags || layout.opacity != opacity) {
+		m_stats.misses++;
+		return nullptr;
+	}
+
+	m_stats.hits++;
+	it->second.last_frame = m_frame;
+	return &it->second.value;
+}
+
+const TextLayout* LayoutCache::storeLayout(uint64_t key, TextLayout&& layout)
+{
+	if (m_layouts.size() >= LAYOUT_CACHE_MAX_ENTRIES)
+		m_layouts.clear();
+
+	auto& entry = m_layouts[key];
+	entry = { std::move(layout), m_frame };
+	return &entry.value;
+}
+
+void LayoutCache::pushLayout(const TextLayout& layout, glm::vec2 pos)
+{
+	const size_t count = layout.quads.size();
+	if (!count)
+		return;
+
+	auto quads = App.context->allocQuads((uint32_t)count);
+	memcpy(quads, layout.quads.data(), count * sizeof(QuadMod));
+
+	if (g_f16c)
+		writeRectsF16C(quads, layout.bounds.data(), count, pos);
+	else
+		writeRects(quads, layout.bounds.data(), count, pos);
+}
+
+void LayoutCache::nextFrame()
+{
+	m_frame++;
+	if (m_frame % LAYOUT_CACHE_MAX_AGE)
+		return;
+
+	std::erase_if(m_runs, [this](const auto& item) { return m_frame - item.second.last_frame > LAYOUT_CACHE_MAX_AGE; });
+	std::erase_if(m_layouts, [this](const auto& item) { return m_frame - item.second.last_frame > LAYOUT_CACHE_MAX_AGE; });
+
+	const uint64_t total = m_stats.hits + m_stats.misses;
+	trace("LayoutCache: %.1f%% hit rate, %d runs, %d layouts.", total ? 100.0 * m_stats.hits / total : 0.0, (int)m_runs.size(), (int)m_layouts.size());
+}
+
+void LayoutCache::clear()
+{
+	m_runs.clear();
+	m_layouts.clear();
+}
+
+uint64_t LayoutCache::hashString(const wchar_t* str)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+	for (; *str; str++)
+		hash = combine(hash, (uint64_t)*str);
+
+	return hash;
+}
+
+}
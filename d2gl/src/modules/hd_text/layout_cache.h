@@ -0,0 +1,106 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+namespace d2gl {
+
+#define LAYOUT_CACHE_MAX_ENTRIES 8192
+#define LAYOUT_CACHE_MAX_AGE 120
+
+struct Glyph;
+
+struct TextGlyph {
+	const Glyph* glyph = nullptr;
+	float x = 0.0f;
+	uint32_t line = 0;
+	wchar_t color = 0;
+	bool symbol = false;
+};
+
+// Line breaks, widths and glyph pen positions of a string, measured once and reused for drawing.
+// The source string and font are kept so a hash collision is a miss instead of another string's text.
+struct TextRun {
+	uint64_t id = 0;
+	std::wstring text;
+	uint32_t font_id = 0;
+	uint32_t generation = 0;
+	int max_chars = 0;
+	glm::vec2 size = { 0.0f, 0.0f };
+	uint32_t line_count = 0;
+	std::vector<float> line_widths;
+	std::vector<TextGlyph> glyphs;
+};
+
+struct TextLayout {
+	uint64_t run_id = 0;
+	uint32_t color = 0;
+	uint32_t flags = 0;
+	float opacity = 1.0f;
+	std::vector<QuadMod> quads;
+	std::vector<glm::vec4> bounds;
+	std::vector<uint16_t> slots;
+};
+
+struct LayoutCacheStats {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+};
+
+class LayoutCache {
+	template <typename T>
+	struct Entry {
+		T value;
+		uint32_t last_frame = 0;
+	};
+
+	std::unordered_map<uint64_t, Entry<std::shared_ptr<const TextRun>>> m_runs;
+	std::unordered_map<uint64_t, Entry<TextLayout>> m_layouts;
+	uint32_t m_frame = 0;
+	uint64_t m_run_count = 0;
+	LayoutCacheStats m_stats;
+
+	LayoutCache() = default;
+	~LayoutCache() = default;
+
+public:
+	static LayoutCache& Instance()
+	{
+		static LayoutCache instance;
+		return instance;
+	}
+
+	std::shared_ptr<const TextRun> findRun(uint64_t key, const wchar_t* str, uint32_t font_id, uint32_t generation, int max_chars);
+	void storeRun(uint64_t key, const std::shared_ptr<const TextRun>& run);
+	inline uint64_t newRunId() { return ++m_run_count; }
+
+	const TextLayout* findLayout(uint64_t key, uint64_t run_id, uint32_t color, uint32_t flags, float opacity);
+	const TextLayout* storeLayout(uint64_t key, TextLayout&& layout);
+	void pushLayout(const TextLayout& layout, glm::vec2 pos);
+
+	void nextFrame();
+	void clear();
+	inline const LayoutCacheStats& getStats() { return m_stats; }
+
+	static uint64_t hashString(const wchar_t* str);
+	static inline uint64_t combine(uint64_t key, uint64_t value) { return (key ^ value) * 0x100000001B3ull; }
+	static inline uint64_t combineFloat(uint64_t key, float value) { return combine(key, (uint64_t)std::bit_cast<uint32_t>(value)); }
+};
+
+}
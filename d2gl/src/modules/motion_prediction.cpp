@@ -42,16 +42,13 @@
 #include "d2/funcs.h"
 #include "d2/stubs.h"
 #include "helpers.h"
+#include "motion_prediction/motion_replay.h"
+#include "profiler.h"
 
 #include <detours/detours.h>
 
 namespace d2gl::modules {
 
-MotionPrediction::MotionPrediction()
-{
-	m_units.reserve(1024);
-}
-
 void MotionPrediction::toggle(bool active)
 {
 	if (!m_active && active) {
@@ -65,6 +62,9 @@ void MotionPrediction::toggle(bool active)
 
 		m_active = true;
 		d2::patch_motion_prediction->toggle(m_active);
+
+		if (App.motion_record && m_recorder.open(App.motion_record_file))
+			trace_log("Recording motion to %s.", App.motion_record_file.c_str());
 	} else if (m_active && !active) {
 		DetourTransactionBegin();
 		DetourUpdateThread(GetCurrentThread());
@@ -76,6 +76,7 @@ void MotionPrediction::toggle(bool active)
 
 		m_active = false;
 		d2::patch_motion_prediction->toggle(m_active);
+		m_recorder.close();
 	}
 	m_global_offset = { 0, 0 };
 	m_player_motion.offset = { 0, 0 };
@@ -83,6 +84,7 @@ void MotionPrediction::toggle(bool active)
 
 void MotionPrediction::update()
 {
+	const ProfileScope scope(ProfileModule::MotionPrediction);
 	if (!isAvailable()) {
 		m_global_offset = { 0, 0 };
 		m_player_motion.offset = { 0, 0 };
@@ -95,23 +97,40 @@ void MotionPrediction::update()
 	int32_t delta = (int32_t)glm::max((int64_t)INT_MIN, glm::min((int64_t)INT_MAX, frame_time_ms));
 
 	m_player_motion.unit = d2::getPlayerUnit();
-	setUnitMotion(&m_player_motion, delta);
+	const d2::Path* player_path = d2::getUnitPath(m_player_motion.unit);
+	const glm::ivec2 player_pos = { (int32_t)player_path->x, (int32_t)player_path->y };
+	const auto params = getPredictorParams((PredictorType)App.motion_predictor.type.selected);
+	stepUnitMotion(m_player_motion.state, player_pos, delta, params);
 
 	const auto frame = App.context->getFrameCount() - 1;
-	for (auto it = m_units.begin(); it != m_units.end();) {
-		if (it->second.frame != frame)
-			it = m_units.erase(it);
-		else {
-			if (it->second.unit = d2::findUnit(it->first)) {
-				setUnitMotion(&it->second, delta);
-				it++;
-			} else
-				it = m_units.erase(it);
-		}
+	for (uint32_t i = 0; i < m_units.size();) {
+		if (m_units.frame(i) != frame || !(m_units.unit(i) = d2::findUnit(m_units.id(i))))
+			m_units.remove(i);
+		else
+			i++;
+	}
+
+	if (m_recorder.isOpen())
+		m_recorder.beginFrame(frame + 1, delta, m_frame_time, player_pos, m_player_motion.screen_pos);
+
+	m_particles.update(frame + 1, m_frame_time);
+
+	m_grid.clear();
+	for (uint32_t i = 0; i < m_units.size(); i++) {
+		const d2::Path* path = d2::getUnitPath(m_units.unit(i));
+		const glm::ivec2 unit_pos = { (int32_t)path->x, (int32_t)path->y };
+		if (m_recorder.isOpen())
+			m_recorder.addUnit(m_units.id(i), unit_pos, m_units.screenPos(i));
+
+		auto& state = m_units.state(i);
+		stepUnitMotion(state, unit_pos, delta, params);
+		m_units.offset(i) = getScreenOffset(state);
+		m_grid.insert(m_units.screenPos(i), i);
 	}
 
 	m_perspective = d2::isPerspective();
-	m_global_offset = getUnitOffset(&m_player_motion);
+	m_player_motion.offset = getScreenOffset(m_player_motion.state);
+	m_global_offset = m_player_motion.offset;
 }
 
 glm::ivec2 MotionPrediction::getGlobalOffset(bool skip)
@@ -132,14 +151,18 @@ glm::ivec2 MotionPrediction::getGlobalOffsetPerspective()
 
 glm::ivec2 MotionPrediction::getUnitOffset(uint32_t type_id)
 {
-	if (isActive())
-		return m_units[type_id].offset;
+	if (isActive()) {
+		const int row = m_units.find(type_id);
+		if (row >= 0)
+			return m_units.offset(row);
+	}
 
 	return { 0, 0 };
 }
 
 glm::ivec2 MotionPrediction::drawImage(int x, int y, D2DrawFn fn, uint32_t gamma, int draw_mode)
 {
+	const ProfileScope scope(ProfileModule::MotionPrediction);
 	glm::ivec2 pos = { x, y };
 	m_draw_fn = fn;
 
@@ -150,12 +173,9 @@ glm::ivec2 MotionPrediction::drawImage(int x, int y, D2DrawFn fn, uint32_t gamma
 		if (glm::max(abs(pos.x - m_player_motion.screen_pos.x), abs(pos.y - m_player_motion.screen_pos.y)) < 16)
 			return pos;
 		else {
-			for (auto& item : m_units) {
-				if (glm::max(abs(item.second.screen_pos.x - pos.x), abs(item.second.screen_pos.y - pos.y)) < 16) {
-					pos += getUnitOffset(&item.second);
-					break;
-				}
-			}
+			const int row = m_grid.find(pos, 16, m_units.screenPositions());
+			if (row >= 0)
+				pos += m_units.offset(row);
 		}
 		return pos - m_global_offset;
 	}
@@ -167,16 +187,18 @@ glm::ivec2 MotionPrediction::drawImage(int x, int y, D2DrawFn fn, uint32_t gamma
 		} else {
 			if (d2::currently_drawing_unit->dwType == d2::UnitType::Player || d2::currently_drawing_unit->dwType == d2::UnitType::Monster || d2::currently_drawing_unit->dwType == d2::UnitType::Missile) {
 				const uint32_t type_id = d2::getUnitID(d2::currently_drawing_unit) | ((uint8_t)d2::currently_drawing_unit->dwType << 24);
-				UnitMotion* unit_motion = &m_units[type_id];
-				const uint32_t frame = App.context->getFrameCount();
-
-				if (unit_motion->frame != frame) {
-					unit_motion->unit = d2::currently_drawing_unit;
-					unit_motion->frame = frame;
-					unit_motion->screen_pos = pos;
+				const int row = m_units.insert(type_id);
+				if (row >= 0) {
+					const uint32_t frame = App.context->getFrameCount();
+					if (m_units.frame(row) != frame) {
+						m_units.unit(row) = d2::currently_drawing_unit;
+						m_units.frame(row) = frame;
+						m_units.screenPos(row) = pos;
+						m_grid.insert(pos, row);
+					}
+					if (fn == D2DrawFn::Image)
+						pos += m_units.offset(row);
 				}
-				if (fn == D2DrawFn::Image)
-					pos += getUnitOffset(unit_motion);
 			}
 			return pos - m_global_offset;
 		}
@@ -190,49 +212,26 @@ glm::ivec2 MotionPrediction::drawImage(int x, int y, D2DrawFn fn, uint32_t gamma
 
 glm::ivec2 MotionPrediction::drawLine(int start_x, int start_y)
 {
+	const ProfileScope scope(ProfileModule::MotionPrediction);
 	if (!isAvailable() || !d2::currently_drawing_weather_particles)
 		return { 0, 0 };
 
-	uint32_t particle_index = *d2::currently_drawing_weather_particle_index_ptr;
-	if (particle_index == m_last_particle_index)
-		particle_index += 256;
-
-	const auto frame = App.context->getFrameCount();
-	ParticleMotion& particle = m_particles[particle_index & 511];
-	m_last_particle_index = particle_index;
-
-	if (particle.frame != frame) {
-		const glm::ivec2 pos = { start_x, start_y };
-		const glm::ivec2 diff = pos - particle.last_pos;
-		const int error = glm::max(abs(diff.x), abs(diff.y));
-
-		if (frame - particle.frame > 2 || error > 100) {
-			particle.last_pos = pos;
-			particle.predicted_pos = pos;
-			particle.velocity = { 0.0f, 0.0f };
-		} else {
-			if (error > 0) {
-				particle.velocity = { 25.0f * diff.x, 25.0f * diff.y };
-				particle.last_pos = pos;
-			}
-		}
-
-		particle.predicted_pos += particle.velocity * m_frame_time;
-		particle.offset = -glm::ivec2(particle.predicted_pos - particle.last_pos);
-		particle.frame = frame;
-	}
+	const uint32_t particle_index = *d2::currently_drawing_weather_particle_index_ptr;
+	const glm::ivec2 pos = { start_x, start_y };
+	if (m_recorder.isOpen())
+		m_recorder.addParticle(particle_index, pos);
 
-	return particle.offset;
+	return m_particles.track(particle_index, pos);
 }
 
 glm::ivec2 MotionPrediction::drawSolidRect()
 {
+	const ProfileScope scope(ProfileModule::MotionPrediction);
 	if (isAvailable() && m_text_fn == D2DrawFn::NormalText) {
 		if (d2::headsup_text_unit && m_player_motion.unit != d2::headsup_text_unit) {
 			if (d2::headsup_text_unit->dwType == d2::UnitType::Monster) {
 				const uint32_t type_id = d2::getUnitID(d2::headsup_text_unit) | ((uint8_t)d2::headsup_text_unit->dwType << 24);
-				const auto unit_offset = getUnitOffset(&m_units[type_id]);
-				return m_global_offset - unit_offset;
+				return m_global_offset - getUnitOffset(type_id);
 			}
 			return m_global_offset;
 		}
@@ -243,6 +242,7 @@ glm::ivec2 MotionPrediction::drawSolidRect()
 
 glm::ivec2 MotionPrediction::drawText(const wchar_t* str, int x, int y, D2DrawFn fn)
 {
+	const ProfileScope scope(ProfileModule::MotionPrediction);
 	glm::ivec2 pos = { x, y };
 	if (!isAvailable() || !str)
 		return pos;
@@ -251,8 +251,7 @@ glm::ivec2 MotionPrediction::drawText(const wchar_t* str, int x, int y, D2DrawFn
 		if (d2::headsup_text_unit && m_player_motion.unit != d2::headsup_text_unit) {
 			if (d2::headsup_text_unit->dwType == d2::UnitType::Monster) {
 				const uint32_t type_id = d2::getUnitID(d2::headsup_text_unit) | ((uint8_t)d2::headsup_text_unit->dwType << 24);
-				const auto unit_offset = getUnitOffset(&m_units[type_id]);
-				pos += unit_offset;
+				pos += getUnitOffset(type_id);
 			}
 			pos -= m_global_offset;
 		}
@@ -310,72 +309,30 @@ void MotionPrediction::altItemsTextMotion()
 	*y2 -= m_global_offset.y;
 }
 
-void MotionPrediction::setUnitMotion(UnitMotion* unit_motion, int32_t delta)
+PredictorParams MotionPrediction::getPredictorParams(PredictorType type)
 {
-	const d2::Path* path = d2::getUnitPath(unit_motion->unit);
-	const glm::ivec2 unit_pos = { (int32_t)path->x, (int32_t)path->y };
-
-	glm::ivec2 pos_whole = { unit_pos.x >> 16, unit_pos.y >> 16 };
-	glm::ivec2 last_pos_whole = { unit_motion->last_pos.x >> 16, unit_motion->last_pos.y >> 16 };
-	glm::ivec2 predicted_pos_whole = { unit_motion->predicted_pos.x >> 16, unit_motion->predicted_pos.y >> 16 };
-
-	int32_t last_pos_md = std::max(abs(pos_whole.x - last_pos_whole.x), abs(pos_whole.y - last_pos_whole.y));
-	int32_t predicted_pos_md = std::max(abs(pos_whole.x - predicted_pos_whole.x), abs(pos_whole.y - predicted_pos_whole.y));
-
-	if (last_pos_md > 2 || predicted_pos_md > 2) {
-		unit_motion->predicted_pos = unit_pos;
-		unit_motion->corrected_pos = unit_pos;
-		unit_motion->last_pos = unit_pos;
-		unit_motion->velocity = { 0, 0 };
-	}
-
-	const int32_t dx = unit_pos.x - unit_motion->last_pos.x;
-	const int32_t dy = unit_pos.y - unit_motion->last_pos.y;
-
-	unit_motion->dt_last_pos_change += delta;
-
-	if (dx != 0 || dy != 0 || unit_motion->dt_last_pos_change >= (65536 / 25)) {
-		unit_motion->corrected_pos.x = ((int64_t)unit_pos.x + unit_motion->last_pos.x) >> 1;
-		unit_motion->corrected_pos.y = ((int64_t)unit_pos.y + unit_motion->last_pos.y) >> 1;
-
-		unit_motion->velocity.x = 25 * dx;
-		unit_motion->velocity.y = 25 * dy;
-
-		unit_motion->last_pos = unit_pos;
-		unit_motion->dt_last_pos_change = 0;
-	}
-
-	if (unit_motion->velocity.x != 0 || unit_motion->velocity.y != 0) {
-		if (unit_motion->dt_last_pos_change < (65536 / 25)) {
-			glm::ivec2 step = { (int32_t)(((int64_t)delta * unit_motion->velocity.x) >> 16), (int32_t)(((int64_t)delta * unit_motion->velocity.y) >> 16) };
-
-			const int32_t correction = 7000;
-			const int32_t one_minus_correction = 65536 - correction;
-
-			unit_motion->predicted_pos.x = (int32_t)(((int64_t)unit_motion->predicted_pos.x * one_minus_correction + (int64_t)unit_motion->corrected_pos.x * correction) >> 16);
-			unit_motion->predicted_pos.y = (int32_t)(((int64_t)unit_motion->predicted_pos.y * one_minus_correction + (int64_t)unit_motion->corrected_pos.y * correction) >> 16);
-
-			unit_motion->predicted_pos.x += step.x;
-			unit_motion->predicted_pos.y += step.y;
-
-			unit_motion->corrected_pos.x += step.x;
-			unit_motion->corrected_pos.y += step.y;
-		}
-	}
-
-	unit_motion->offset_update = true;
+	PredictorParams params;
+	params.type = type;
+	params.correction = App.motion_predictor.correction.value;
+	params.alpha = (int32_t)(App.motion_predictor.alpha.value * 65536.0f);
+	params.beta = (int32_t)(App.motion_predictor.beta.value * 65536.0f);
+	params.process_noise = (int32_t)(App.motion_predictor.process_noise.value * 65536.0f);
+	params.measure_noise = (int32_t)(App.motion_predictor.measure_noise.value * 65536.0f);
+
+	return params;
 }
 
-glm::ivec2 MotionPrediction::getUnitOffset(UnitMotion* unit_motion)
+void MotionPrediction::replay(const std::string& path)
 {
-	if (unit_motion->offset_update) {
-		const glm::vec2 offset = { (unit_motion->predicted_pos.x - unit_motion->last_pos.x) / 65536.0f, (unit_motion->predicted_pos.y - unit_motion->last_pos.y) / 65536.0f };
-		const glm::vec2 scale_factors = { 32.0f / sqrtf(2.0f), 16.0f / sqrtf(2.0f) };
-		const glm::vec2 screen_offset = scale_factors * glm::vec2(offset.x - offset.y, offset.x + offset.y) + 0.5f;
-		unit_motion->offset = { (int)screen_offset.x, (int)screen_offset.y };
-		unit_motion->offset_update = false;
+	for (const auto& item : App.motion_predictor.type.items) {
+		ReplayStats stats;
+		if (!replayMotion(path, stats, getPredictorParams((PredictorType)item.value))) {
+			error_log("Motion replay: Could not read %s.", path.c_str());
+			return;
+		}
+		trace_log("Motion replay (%s): %u frames, %llu units, %llu particles | error avg %.2f max %.2f px | jitter avg %.2f max %.2f px | snaps %u units %u particles | %.2f us/frame",
+			item.name.c_str(), stats.frames, stats.unit_samples, stats.particle_samples, stats.mean_error, stats.max_error, stats.mean_jitter, stats.max_jitter, stats.unit_snaps, stats.particle_snaps, stats.cpu_us_per_frame);
 	}
-	return unit_motion->offset;
 }
 
 }
\ No newline at end of file
@@ -19,30 +19,18 @@
 #pragma once
 
 #include "d2/structs.h"
+#include "motion_prediction/motion_recorder.h"
+#include "motion_prediction/particle_tracker.h"
+#include "motion_prediction/screen_grid.h"
+#include "motion_prediction/unit_table.h"
 
 namespace d2gl::modules {
 
 struct UnitMotion {
-	uint32_t frame = 0;
 	d2::UnitAny* unit = nullptr;
 	glm::ivec2 screen_pos = { 0, 0 };
 	glm::ivec2 offset = { 0, 0 };
-	bool offset_update = false;
-
-	glm::ivec2 last_pos = { 0, 0 };
-	glm::ivec2 predicted_pos = { 0, 0 };
-	glm::ivec2 corrected_pos = { 0, 0 };
-	glm::ivec2 velocity = { 0, 0 };
-	int64_t dt_last_pos_change = 0;
-};
-
-struct ParticleMotion {
-	uint32_t frame = 0;
-	glm::ivec2 offset = { 0, 0 };
-
-	glm::ivec2 last_pos = { 0, 0 };
-	glm::ivec2 predicted_pos = { 0, 0 };
-	glm::vec2 velocity = { 0.0f, 0.0f };
+	MotionState state;
 };
 
 class MotionPrediction {
@@ -50,17 +38,19 @@ class MotionPrediction {
 	float m_frame_time = 0.0f;
 	glm::ivec2 m_global_offset = { 0, 0 };
 
-	std::unordered_map<uint32_t, UnitMotion> m_units;
+	UnitTable m_units;
+	ScreenGrid m_grid;
 	UnitMotion m_player_motion;
 	bool m_perspective = false;
 
 	D2DrawFn m_text_fn = D2DrawFn::None;
 	D2DrawFn m_draw_fn = D2DrawFn::None;
 
-	std::array<ParticleMotion, 512> m_particles;
-	uint32_t m_last_particle_index = 0;
+	ParticleTracker m_particles;
+
+	MotionRecorder m_recorder;
 
-	MotionPrediction();
+	MotionPrediction() = default;
 	~MotionPrediction() = default;
 
 public:
@@ -87,11 +77,10 @@ public:
 	void altItemsTextMotion();
 
 	inline void textMotion(D2DrawFn fn) { m_text_fn = fn; }
+	void replay(const std::string& path);
+	static PredictorParams getPredictorParams(PredictorType type);
 
 private:
-	void setUnitMotion(UnitMotion* unit_motion, int32_t delta);
-	glm::ivec2 getUnitOffset(UnitMotion* unit_motion);
-
 	inline bool isAvailable() { return m_active && App.game.screen == GameScreen::InGame; }
 };
 
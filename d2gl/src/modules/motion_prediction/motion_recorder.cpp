@@ -0,0 +1,75 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "motion_recorder.h"
+
+namespace d2gl::modules {
+
+bool MotionRecorder::open(const std::string& path)
+{
+	close();
+
+	m_file.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_file.is_open())
+		return false;
+
+	const RecordHeader header;
+	m_file.write((const char*)&header, sizeof(RecordHeader));
+	m_units.reserve(1024);
+	m_particles.reserve(512);
+
+	return true;
+}
+
+void MotionRecorder::close()
+{
+	if (!m_file.is_open())
+		return;
+
+	flush();
+	m_file.close();
+}
+
+void MotionRecorder::beginFrame(uint32_t frame, int32_t delta, float frame_time, glm::ivec2 player_pos, glm::ivec2 player_screen_pos)
+{
+	flush();
+
+	m_frame = { frame, delta, frame_time, player_pos, player_screen_pos };
+	m_pending = true;
+}
+
+void MotionRecorder::flush()
+{
+	if (!m_pending)
+		return;
+
+	m_frame.unit_count = (uint32_t)m_units.size();
+	m_frame.particle_count = (uint32_t)m_particles.size();
+
+	m_file.write((const char*)&m_frame, sizeof(RecordFrame));
+	m_file.write((const char*)m_units.data(), m_units.size() * sizeof(RecordUnit));
+	m_file.write((const char*)m_particles.data(), m_particles.size() * sizeof(RecordParticle));
+
+	m_units.clear();
+	m_particles.clear();
+	m_pending = false;
+}
+
+}
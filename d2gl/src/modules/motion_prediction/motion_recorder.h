@@ -0,0 +1,77 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+namespace d2gl::modules {
+
+#define MOTION_RECORD_MAGIC 0x524D3244 // "D2MR"
+#define MOTION_RECORD_VERSION 2
+
+// Recording layout: RecordHeader, then per frame a RecordFrame followed by
+// unit_count RecordUnit and particle_count RecordParticle entries.
+struct RecordHeader {
+	uint32_t magic = MOTION_RECORD_MAGIC;
+	uint32_t version = MOTION_RECORD_VERSION;
+};
+
+struct RecordFrame {
+	uint32_t frame = 0;
+	int32_t delta = 0;
+	float frame_time = 0.0f;
+	glm::ivec2 player_pos = { 0, 0 };
+	glm::ivec2 player_screen_pos = { 0, 0 };
+	uint32_t unit_count = 0;
+	uint32_t particle_count = 0;
+};
+
+struct RecordUnit {
+	uint32_t id;
+	glm::ivec2 path_pos;
+	glm::ivec2 screen_pos;
+};
+
+struct RecordParticle {
+	uint32_t index;
+	glm::ivec2 pos;
+};
+
+class MotionRecorder {
+	std::ofstream m_file;
+	RecordFrame m_frame;
+	std::vector<RecordUnit> m_units;
+	std::vector<RecordParticle> m_particles;
+	bool m_pending = false;
+
+	void flush();
+
+public:
+	MotionRecorder() = default;
+	~MotionRecorder() { close(); }
+
+	bool open(const std::string& path);
+	void close();
+	inline bool isOpen() { return m_file.is_open(); }
+
+	void beginFrame(uint32_t frame, int32_t delta, float frame_time, glm::ivec2 player_pos, glm::ivec2 player_screen_pos);
+	inline void addUnit(uint32_t id, glm::ivec2 path_pos, glm::ivec2 screen_pos) { m_units.push_back({ id, path_pos, screen_pos }); }
+	inline void addParticle(uint32_t index, glm::ivec2 pos) { m_particles.push_back({ index, pos }); }
+};
+
+}
@@ -0,0 +1,141 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "motion_replay.h"
+#include "motion_recorder.h"
+#include "particle_tracker.h"
+
+namespace d2gl::modules {
+
+namespace {
+
+struct ReplayUnit {
+	MotionState state;
+	uint32_t frame = 0;
+	bool seen = false;
+	glm::vec2 predicted = { 0.0f, 0.0f };
+	glm::vec2 drawn[2] = {};
+	uint32_t drawn_count = 0;
+};
+
+inline glm::vec2 toTiles(glm::ivec2 pos)
+{
+	return glm::vec2(pos) / 65536.0f;
+}
+
+}
+
+bool replayMotion(const std::string& path, ReplayStats& stats, const PredictorParams& params)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+		return false;
+
+	RecordHeader header;
+	file.read((char*)&header, sizeof(RecordHeader));
+	if (!file || header.magic != MOTION_RECORD_MAGIC || header.version != MOTION_RECORD_VERSION)
+		return false;
+
+	stats = {};
+	std::unordered_map<uint32_t, ReplayUnit> units;
+	ParticleTracker particles;
+	MotionState player;
+
+	std::vector<RecordUnit> frame_units;
+	std::vector<RecordParticle> frame_particles;
+	std::vector<ReplayUnit*> rows;
+
+	double error_sum = 0.0;
+	double jitter_sum = 0.0;
+	uint64_t error_count = 0;
+	uint64_t jitter_count = 0;
+	std::chrono::steady_clock::duration cpu_time = {};
+
+	RecordFrame frame;
+	while (file.read((char*)&frame, sizeof(RecordFrame))) {
+		frame_units.resize(frame.unit_count);
+		frame_particles.resize(frame.particle_count);
+		file.read((char*)frame_units.data(), frame_units.size() * sizeof(RecordUnit));
+		file.read((char*)frame_particles.data(), frame_particles.size() * sizeof(RecordParticle));
+		if (!file)
+			break;
+
+		rows.clear();
+		for (const auto& item : frame_units) {
+			auto& unit = units[item.id];
+			if (unit.seen && unit.frame + 1 == frame.frame) {
+				const float error = glm::length(tileToScreen(toTiles(item.path_pos) - unit.predicted));
+				error_sum += error;
+				error_count++;
+				stats.max_error = glm::max(stats.max_error, error);
+			}
+			rows.push_back(&unit);
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		stepUnitMotion(player, frame.player_pos, frame.delta, params);
+		for (size_t i = 0; i < rows.size(); i++) {
+			if (stepUnitMotion(rows[i]->state, frame_units[i].path_pos, frame.delta, params) && rows[i]->seen)
+				stats.unit_snaps++;
+		}
+		particles.update(frame.frame, frame.frame_time);
+		const bool tracking = particles.size() > 0;
+		const uint32_t created = particles.getCreatedCount();
+		for (const auto& item : frame_particles)
+			particles.track(item.index, item.pos);
+		if (tracking)
+			stats.particle_snaps += particles.getCreatedCount() - created;
+		cpu_time += std::chrono::steady_clock::now() - start;
+
+		const glm::ivec2 global_offset = getScreenOffset(player);
+		for (size_t i = 0; i < rows.size(); i++) {
+			auto& unit = *rows[i];
+			if (!unit.seen || unit.frame + 1 != frame.frame)
+				unit.drawn_count = 0;
+
+			const glm::vec2 drawn = glm::vec2(frame_units[i].screen_pos + getScreenOffset(unit.state) - global_offset);
+			if (unit.drawn_count >= 2) {
+				const float jitter = glm::length(drawn - 2.0f * unit.drawn[1] + unit.drawn[0]);
+				jitter_sum += jitter;
+				jitter_count++;
+				stats.max_jitter = glm::max(stats.max_jitter, jitter);
+			}
+			unit.drawn[0] = unit.drawn[1];
+			unit.drawn[1] = drawn;
+			unit.drawn_count++;
+
+			unit.predicted = toTiles(unit.state.predicted_pos);
+			unit.frame = frame.frame;
+			unit.seen = true;
+		}
+
+		stats.frames++;
+		stats.unit_samples += frame_units.size();
+		stats.particle_samples += frame_particles.size();
+	}
+
+	stats.mean_error = error_count ? (float)(error_sum / error_count) : 0.0f;
+	stats.mean_jitter = jitter_count ? (float)(jitter_sum / jitter_count) : 0.0f;
+	stats.cpu_us_per_frame = stats.frames ? std::chrono::duration<double, std::micro>(cpu_time).count() / stats.frames : 0.0;
+
+	return true;
+}
+
+}
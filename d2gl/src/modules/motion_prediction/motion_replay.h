@@ -0,0 +1,43 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "predictor.h"
+
+namespace d2gl::modules {
+
+// Error is the screen distance between a unit's predicted position and the position the game reports next frame,
+// jitter is the second difference of a unit's drawn position over consecutive frames, both in pixels.
+struct ReplayStats {
+	uint32_t frames = 0;
+	uint64_t unit_samples = 0;
+	uint64_t particle_samples = 0;
+	float mean_error = 0.0f;
+	float max_error = 0.0f;
+	float mean_jitter = 0.0f;
+	float max_jitter = 0.0f;
+	uint32_t unit_snaps = 0;
+	uint32_t particle_snaps = 0;
+	double cpu_us_per_frame = 0.0;
+};
+
+bool replayMotion(const std::string& path, ReplayStats& stats, const PredictorParams& params = {});
+
+}
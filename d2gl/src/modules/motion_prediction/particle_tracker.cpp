@@ -0,0 +1,162 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+/*
+	Part of this file is part of D2DX.
+	https://github.com/bolrog/d2dx/blob/main/src/d2dx/WeatherMotionPredictor.cpp
+
+	Copyright (C) 2021  Bolrog
+
+	D2DX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	D2DX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with D2DX. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.h"
+#include "particle_tracker.h"
+
+#include <immintrin.h>
+
+namespace d2gl::modules {
+
+ParticleTracker::ParticleTracker()
+{
+	m_heads.fill(-1);
+}
+
+int32_t* ParticleTracker::findLink(uint32_t track)
+{
+	int32_t* link = &m_heads[m_index[track] & (PARTICLE_TRACKER_INDEX_SIZE - 1)];
+	while (*link != (int32_t)track)
+		link = &m_next[*link];
+
+	return link;
+}
+
+void ParticleTracker::remove(uint32_t track)
+{
+	*findLink(track) = m_next[track];
+
+	const uint32_t last = size() - 1;
+	if (track != last) {
+		*findLink(last) = (int32_t)track;
+		m_pos_x[track] = m_pos_x[last];
+		m_pos_y[track] = m_pos_y[last];
+		m_vel_x[track] = m_vel_x[last];
+		m_vel_y[track] = m_vel_y[last];
+		m_last_pos[track] = m_last_pos[last];
+		m_index[track] = m_index[last];
+		m_frames[track] = m_frames[last];
+		m_next[track] = m_next[last];
+	}
+
+	m_pos_x.pop_back();
+	m_pos_y.pop_back();
+	m_vel_x.pop_back();
+	m_vel_y.pop_back();
+	m_last_pos.pop_back();
+	m_index.pop_back();
+	m_frames.pop_back();
+	m_next.pop_back();
+}
+
+void ParticleTracker::advance(float frame_time)
+{
+	const size_t count = m_pos_x.size();
+	const __m128 step = _mm_set1_ps(frame_time);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		_mm_storeu_ps(&m_pos_x[i], _mm_add_ps(_mm_loadu_ps(&m_pos_x[i]), _mm_mul_ps(_mm_loadu_ps(&m_vel_x[i]), step)));
+		_mm_storeu_ps(&m_pos_y[i], _mm_add_ps(_mm_loadu_ps(&m_pos_y[i]), _mm_mul_ps(_mm_loadu_ps(&m_vel_y[i]), step)));
+	}
+	for (; i < count; i++) {
+		m_pos_x[i] += m_vel_x[i] * frame_time;
+		m_pos_y[i] += m_vel_y[i] * frame_time;
+	}
+}
+
+void ParticleTracker::update(uint32_t frame, float frame_time)
+{
+	m_frame = frame;
+
+	for (uint32_t i = 0; i < size();) {
+		if (frame - m_frames[i] > PARTICLE_TRACKER_MAX_AGE)
+			remove(i);
+		else
+			i++;
+	}
+
+	advance(frame_time);
+}
+
+glm::ivec2 ParticleTracker::track(uint32_t index, glm::ivec2 pos)
+{
+	int32_t found = -1;
+	int best = PARTICLE_TRACKER_MAX_ERROR + 1;
+	for (int32_t i = m_heads[index & (PARTICLE_TRACKER_INDEX_SIZE - 1)]; i >= 0; i = m_next[i]) {
+		if (m_index[i] != index || m_frames[i] == m_frame)
+			continue;
+
+		const glm::ivec2 diff = pos - m_last_pos[i];
+		const int error = glm::max(abs(diff.x), abs(diff.y));
+		if (error < best) {
+			best = error;
+			found = i;
+		}
+	}
+
+	if (found < 0) {
+		auto& head = m_heads[index & (PARTICLE_TRACKER_INDEX_SIZE - 1)];
+		m_pos_x.push_back((float)pos.x);
+		m_pos_y.push_back((float)pos.y);
+		m_vel_x.push_back(0.0f);
+		m_vel_y.push_back(0.0f);
+		m_last_pos.push_back(pos);
+		m_index.push_back(index);
+		m_frames.push_back(m_frame);
+		m_next.push_back(head);
+		head = (int32_t)size() - 1;
+		m_created++;
+
+		return { 0, 0 };
+	}
+
+	if (best > 0) {
+		const glm::ivec2 diff = pos - m_last_pos[found];
+		m_vel_x[found] = 25.0f * diff.x;
+		m_vel_y[found] = 25.0f * diff.y;
+		m_last_pos[found] = pos;
+		m_pos_x[found] += (pos.x - m_pos_x[found]) * PARTICLE_TRACKER_CORRECTION;
+		m_pos_y[found] += (pos.y - m_pos_y[found]) * PARTICLE_TRACKER_CORRECTION;
+	}
+	m_frames[found] = m_frame;
+
+	const glm::vec2 offset = glm::vec2(m_pos_x[found], m_pos_y[found]) - glm::vec2(m_last_pos[found]);
+	return -glm::ivec2(glm::floor(offset + 0.5f));
+}
+
+}
@@ -0,0 +1,61 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+namespace d2gl::modules {
+
+#define PARTICLE_TRACKER_INDEX_SIZE 4096
+#define PARTICLE_TRACKER_MAX_ERROR 100
+#define PARTICLE_TRACKER_MAX_AGE 2
+#define PARTICLE_TRACKER_CORRECTION 0.5f
+
+// Weather particle tracks stored as parallel arrays. The game particle index narrows the candidates,
+// the track is then picked by distance to its last position so repeated or reused indices don't swap tracks.
+// Predictions are advanced for all tracks at once in update(), new game positions pull them halfway back.
+class ParticleTracker {
+	std::vector<float> m_pos_x;
+	std::vector<float> m_pos_y;
+	std::vector<float> m_vel_x;
+	std::vector<float> m_vel_y;
+	std::vector<glm::ivec2> m_last_pos;
+	std::vector<uint32_t> m_index;
+	std::vector<uint32_t> m_frames;
+	std::vector<int32_t> m_next;
+	std::array<int32_t, PARTICLE_TRACKER_INDEX_SIZE> m_heads;
+
+	uint32_t m_frame = 0;
+	uint32_t m_created = 0;
+
+	int32_t* findLink(uint32_t track);
+	void remove(uint32_t track);
+	void advance(float frame_time);
+
+public:
+	ParticleTracker();
+	~ParticleTracker() = default;
+
+	void update(uint32_t frame, float frame_time);
+	glm::ivec2 track(uint32_t index, glm::ivec2 pos);
+
+	inline uint32_t size() const { return (uint32_t)m_index.size(); }
+	inline uint32_t getCreatedCount() const { return m_created; }
+};
+
+}
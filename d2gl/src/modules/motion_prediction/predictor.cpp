@@ -0,0 +1,233 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+/*
+	Part of this file is part of D2DX.
+	https://github.com/bolrog/d2dx/blob/main/src/d2dx/UnitMotionPredictor.cpp
+
+	Copyright (C) 2021  Bolrog
+
+	D2DX is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	D2DX is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with D2DX. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.h"
+#include "predictor.h"
+
+namespace d2gl::modules {
+
+namespace {
+
+inline int32_t clampFixed(int64_t value, int32_t limit)
+{
+	return (int32_t)glm::clamp(value, -(int64_t)limit, (int64_t)limit);
+}
+
+inline glm::ivec2 advance(glm::ivec2 velocity, int64_t delta)
+{
+	return { (int32_t)((delta * velocity.x) >> 16), (int32_t)((delta * velocity.y) >> 16) };
+}
+
+// A position more than two tiles away from both the last and predicted position is a teleport, not motion.
+bool isJump(const MotionState& state, glm::ivec2 unit_pos)
+{
+	glm::ivec2 pos_whole = { unit_pos.x >> 16, unit_pos.y >> 16 };
+	glm::ivec2 last_pos_whole = { state.last_pos.x >> 16, state.last_pos.y >> 16 };
+	glm::ivec2 predicted_pos_whole = { state.predicted_pos.x >> 16, state.predicted_pos.y >> 16 };
+
+	int32_t last_pos_md = std::max(abs(pos_whole.x - last_pos_whole.x), abs(pos_whole.y - last_pos_whole.y));
+	int32_t predicted_pos_md = std::max(abs(pos_whole.x - predicted_pos_whole.x), abs(pos_whole.y - predicted_pos_whole.y));
+
+	return last_pos_md > 2 || predicted_pos_md > 2;
+}
+
+inline void resetState(MotionState& state, glm::ivec2 unit_pos, const PredictorParams& params)
+{
+	state.predicted_pos = unit_pos;
+	state.corrected_pos = unit_pos;
+	state.last_pos = unit_pos;
+	state.velocity = { 0, 0 };
+	state.dt_last_pos_change = 0;
+	state.covariance = { glm::max(params.measure_noise, 1), 0, MOTION_INITIAL_VELOCITY_VARIANCE };
+}
+
+// A new game position arrives when the unit moved or a full 25 fps game tick passed without movement.
+inline bool isMeasurement(const MotionState& state, glm::ivec2 unit_pos)
+{
+	return unit_pos != state.last_pos || state.dt_last_pos_change >= (65536 / 25);
+}
+
+bool stepD2DX(MotionState& state, glm::ivec2 unit_pos, int32_t delta, int32_t correction)
+{
+	bool snapped = false;
+
+	if (isJump(state, unit_pos)) {
+		state.predicted_pos = unit_pos;
+		state.corrected_pos = unit_pos;
+		state.last_pos = unit_pos;
+		state.velocity = { 0, 0 };
+		snapped = true;
+	}
+
+	const int32_t dx = unit_pos.x - state.last_pos.x;
+	const int32_t dy = unit_pos.y - state.last_pos.y;
+
+	state.dt_last_pos_change += delta;
+
+	if (dx != 0 || dy != 0 || state.dt_last_pos_change >= (65536 / 25)) {
+		state.corrected_pos.x = ((int64_t)unit_pos.x + state.last_pos.x) >> 1;
+		state.corrected_pos.y = ((int64_t)unit_pos.y + state.last_pos.y) >> 1;
+
+		state.velocity.x = 25 * dx;
+		state.velocity.y = 25 * dy;
+
+		state.last_pos = unit_pos;
+		state.dt_last_pos_change = 0;
+	}
+
+	if (state.velocity.x != 0 || state.velocity.y != 0) {
+		if (state.dt_last_pos_change < (65536 / 25)) {
+			const glm::ivec2 step = advance(state.velocity, delta);
+
+			const int32_t one_minus_correction = 65536 - correction;
+
+			state.predicted_pos.x = (int32_t)(((int64_t)state.predicted_pos.x * one_minus_correction + (int64_t)state.corrected_pos.x * correction) >> 16);
+			state.predicted_pos.y = (int32_t)(((int64_t)state.predicted_pos.y * one_minus_correction + (int64_t)state.corrected_pos.y * correction) >> 16);
+
+			state.predicted_pos.x += step.x;
+			state.predicted_pos.y += step.y;
+
+			state.corrected_pos.x += step.x;
+			state.corrected_pos.y += step.y;
+		}
+	}
+
+	return snapped;
+}
+
+bool stepAlphaBeta(MotionState& state, glm::ivec2 unit_pos, int32_t delta, const PredictorParams& params)
+{
+	if (isJump(state, unit_pos)) {
+		resetState(state, unit_pos, params);
+		return true;
+	}
+
+	state.dt_last_pos_change += delta;
+	state.predicted_pos += advance(state.velocity, delta);
+
+	if (isMeasurement(state, unit_pos)) {
+		const int64_t elapsed = glm::max(state.dt_last_pos_change, (int64_t)1);
+		const glm::ivec2 residual = unit_pos - state.predicted_pos;
+
+		for (int i = 0; i < 2; i++) {
+			state.predicted_pos[i] += (int32_t)(((int64_t)residual[i] * params.alpha) >> 16);
+			state.velocity[i] = clampFixed(state.velocity[i] + (int64_t)residual[i] * params.beta / elapsed, MOTION_MAX_VELOCITY);
+		}
+
+		state.last_pos = unit_pos;
+		state.dt_last_pos_change = 0;
+	}
+
+	return false;
+}
+
+// Constant velocity Kalman filter, both axes share one covariance (p00, p01, p11) since their noise is the same.
+bool stepKalman(MotionState& state, glm::ivec2 unit_pos, int32_t delta, const PredictorParams& params)
+{
+	if (isJump(state, unit_pos) || state.covariance.x <= 0) {
+		resetState(state, unit_pos, params);
+		return true;
+	}
+
+	state.dt_last_pos_change += delta;
+	state.predicted_pos += advance(state.velocity, delta);
+
+	const int64_t dt = delta;
+	const int64_t dt2 = (dt * dt) >> 16;
+	const int64_t dt3 = (dt2 * dt) >> 16;
+	const int64_t q = params.process_noise;
+
+	int64_t p00 = state.covariance.x;
+	int64_t p01 = state.covariance.y;
+	int64_t p11 = state.covariance.z;
+
+	p00 += ((dt * (2 * p01 + ((dt * p11) >> 16))) >> 16) + ((q * dt3) >> 16) / 3;
+	p01 += ((dt * p11) >> 16) + ((q * dt2) >> 16) / 2;
+	p11 += (q * dt) >> 16;
+
+	if (isMeasurement(state, unit_pos)) {
+		const int64_t s = glm::max(p00 + params.measure_noise, (int64_t)1);
+		const int64_t k0 = (p00 << 16) / s;
+		const int64_t k1 = (p01 << 16) / s;
+		const glm::ivec2 residual = unit_pos - state.predicted_pos;
+
+		for (int i = 0; i < 2; i++) {
+			state.predicted_pos[i] += (int32_t)((residual[i] * k0) >> 16);
+			state.velocity[i] = clampFixed(state.velocity[i] + ((residual[i] * k1) >> 16), MOTION_MAX_VELOCITY);
+		}
+
+		p11 -= (k1 * p01) >> 16;
+		p00 = ((65536 - k0) * p00) >> 16;
+		p01 = ((65536 - k0) * p01) >> 16;
+
+		state.last_pos = unit_pos;
+		state.dt_last_pos_change = 0;
+	}
+
+	state.covariance.x = (int32_t)glm::clamp(p00, (int64_t)1, (int64_t)INT_MAX);
+	state.covariance.y = clampFixed(p01, INT_MAX);
+	state.covariance.z = (int32_t)glm::clamp(p11, (int64_t)0, (int64_t)INT_MAX);
+
+	return false;
+}
+
+}
+
+bool stepUnitMotion(MotionState& state, glm::ivec2 unit_pos, int32_t delta, const PredictorParams& params)
+{
+	switch (params.type) {
+		case PredictorType::AlphaBeta: return stepAlphaBeta(state, unit_pos, delta, params);
+		case PredictorType::Kalman: return stepKalman(state, unit_pos, delta, params);
+		case PredictorType::D2DX:
+		default: return stepD2DX(state, unit_pos, delta, params.correction);
+	}
+}
+
+glm::ivec2 getScreenOffset(const MotionState& state)
+{
+	const glm::vec2 offset = { (state.predicted_pos.x - state.last_pos.x) / 65536.0f, (state.predicted_pos.y - state.last_pos.y) / 65536.0f };
+	const glm::vec2 screen_offset = tileToScreen(offset) + 0.5f;
+	return { (int)screen_offset.x, (int)screen_offset.y };
+}
+
+glm::vec2 tileToScreen(glm::vec2 tiles)
+{
+	const glm::vec2 scale_factors = { 32.0f / sqrtf(2.0f), 16.0f / sqrtf(2.0f) };
+	return scale_factors * glm::vec2(tiles.x - tiles.y, tiles.x + tiles.y);
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+namespace d2gl::modules {
+
+#define MOTION_CORRECTION 7000
+#define MOTION_MAX_VELOCITY (64 << 16)
+#define MOTION_INITIAL_VELOCITY_VARIANCE (16 << 16)
+
+enum class PredictorType : uint8_t {
+	D2DX,
+	AlphaBeta,
+	Kalman,
+};
+
+// Gains are 16.16 fixed point, noise is tiles^2 (measurement) and tiles^2/s^3 (process) in 16.16.
+struct PredictorParams {
+	PredictorType type = PredictorType::D2DX;
+	int32_t correction = MOTION_CORRECTION;
+	int32_t alpha = 32768;
+	int32_t beta = 13107;
+	int32_t process_noise = 50 << 16;
+	int32_t measure_noise = 655;
+};
+
+struct MotionState {
+	glm::ivec2 last_pos = { 0, 0 };
+	glm::ivec2 predicted_pos = { 0, 0 };
+	glm::ivec2 corrected_pos = { 0, 0 };
+	glm::ivec2 velocity = { 0, 0 };
+	int64_t dt_last_pos_change = 0;
+	glm::ivec3 covariance = { 0, 0, 0 };
+};
+
+// Game independent prediction steps, shared by the in game hooks and the offline replay.
+// Unit positions are 16.16 fixed point tile coordinates, delta is the frame time in 16.16 seconds.
+// Every predictor leaves last_pos at the game position and predicted_pos at its estimate, returns true when it snapped.
+bool stepUnitMotion(MotionState& state, glm::ivec2 unit_pos, int32_t delta, const PredictorParams& params = {});
+glm::ivec2 getScreenOffset(const MotionState& state);
+glm::vec2 tileToScreen(glm::vec2 tiles);
+
+}
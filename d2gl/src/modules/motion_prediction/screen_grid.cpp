@@ -0,0 +1,69 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "screen_grid.h"
+
+namespace d2gl::modules {
+
+ScreenGrid::ScreenGrid()
+{
+	m_entries.reserve(4096);
+}
+
+void ScreenGrid::clear()
+{
+	m_heads.fill(0);
+	m_entries.clear();
+}
+
+void ScreenGrid::insert(glm::ivec2 pos, uint32_t row)
+{
+	if (m_entries.size() >= 0xFFFF)
+		return;
+
+	const uint32_t index = bucket(pos.x >> SCREEN_GRID_CELL_SHIFT, pos.y >> SCREEN_GRID_CELL_SHIFT);
+	m_entries.push_back({ (uint16_t)row, m_heads[index] });
+	m_heads[index] = (uint16_t)m_entries.size();
+}
+
+int ScreenGrid::find(glm::ivec2 pos, int range, const glm::ivec2* positions) const
+{
+	const glm::ivec2 min_cell = (pos - range) >> SCREEN_GRID_CELL_SHIFT;
+	const glm::ivec2 max_cell = (pos + range) >> SCREEN_GRID_CELL_SHIFT;
+
+	int found = -1;
+	int best = range;
+	for (int y = min_cell.y; y <= max_cell.y; y++) {
+		for (int x = min_cell.x; x <= max_cell.x; x++) {
+			for (uint16_t i = m_heads[bucket(x, y)]; i; i = m_entries[i - 1].next) {
+				const auto row = m_entries[i - 1].row;
+				const int dist = glm::max(abs(positions[row].x - pos.x), abs(positions[row].y - pos.y));
+				if (dist < best || (dist == best && row < found)) {
+					best = dist;
+					found = row;
+				}
+			}
+		}
+	}
+
+	return found;
+}
+
+}
@@ -0,0 +1,49 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+namespace d2gl::modules {
+
+#define SCREEN_GRID_CELL_SHIFT 5
+#define SCREEN_GRID_BUCKETS 1024
+
+// Screen space buckets of unit table rows, rebuilt every frame. A row may be listed under an older position too,
+// lookups check the distance against the current positions so such leftovers are ignored.
+class ScreenGrid {
+	struct Entry {
+		uint16_t row;
+		uint16_t next;
+	};
+
+	std::array<uint16_t, SCREEN_GRID_BUCKETS> m_heads = { 0 };
+	std::vector<Entry> m_entries;
+
+	static inline uint32_t bucket(int cell_x, int cell_y) { return ((uint32_t)cell_x * 73856093u ^ (uint32_t)cell_y * 19349663u) & (SCREEN_GRID_BUCKETS - 1); }
+
+public:
+	ScreenGrid();
+	~ScreenGrid() = default;
+
+	void clear();
+	void insert(glm::ivec2 pos, uint32_t row);
+	int find(glm::ivec2 pos, int range, const glm::ivec2* positions) const;
+};
+
+}
@@ -0,0 +1,120 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "unit_table.h"
+
+namespace d2gl::modules {
+
+#define INDEX_MASK (UNIT_TABLE_INDEX_SIZE - 1)
+
+UnitTable::UnitTable()
+{
+	m_ids.reserve(UNIT_TABLE_CAPACITY);
+	m_frames.reserve(UNIT_TABLE_CAPACITY);
+	m_units.reserve(UNIT_TABLE_CAPACITY);
+	m_screen_pos.reserve(UNIT_TABLE_CAPACITY);
+	m_offsets.reserve(UNIT_TABLE_CAPACITY);
+	m_states.reserve(UNIT_TABLE_CAPACITY);
+}
+
+uint32_t UnitTable::findSlot(uint32_t id) const
+{
+	uint32_t slot = hash(id);
+	while (m_index[slot] && m_ids[m_index[slot] - 1] != id)
+		slot = (slot + 1) & INDEX_MASK;
+
+	return slot;
+}
+
+void UnitTable::eraseSlot(uint32_t slot)
+{
+	// Backward shift deletion: pull later entries of the probe chain into the hole when their home slot allows it.
+	uint32_t hole = slot;
+	for (uint32_t i = (hole + 1) & INDEX_MASK; m_index[i]; i = (i + 1) & INDEX_MASK) {
+		const uint32_t home = hash(m_ids[m_index[i] - 1]);
+		if (((i - home) & INDEX_MASK) >= ((i - hole) & INDEX_MASK)) {
+			m_index[hole] = m_index[i];
+			hole = i;
+		}
+	}
+	m_index[hole] = 0;
+}
+
+int UnitTable::find(uint32_t id) const
+{
+	const auto row = m_index[findSlot(id)];
+	return (int)row - 1;
+}
+
+int UnitTable::insert(uint32_t id)
+{
+	const uint32_t slot = findSlot(id);
+	if (m_index[slot])
+		return m_index[slot] - 1;
+
+	if (m_ids.size() >= UNIT_TABLE_CAPACITY)
+		return -1;
+
+	m_ids.push_back(id);
+	m_frames.push_back(0);
+	m_units.push_back(nullptr);
+	m_screen_pos.push_back({ 0, 0 });
+	m_offsets.push_back({ 0, 0 });
+	m_states.push_back({});
+	m_index[slot] = (uint16_t)m_ids.size();
+
+	return (int)m_ids.size() - 1;
+}
+
+void UnitTable::remove(uint32_t row)
+{
+	eraseSlot(findSlot(m_ids[row]));
+
+	const uint32_t last = size() - 1;
+	if (row != last) {
+		m_index[findSlot(m_ids[last])] = (uint16_t)(row + 1);
+		m_ids[row] = m_ids[last];
+		m_frames[row] = m_frames[last];
+		m_units[row] = m_units[last];
+		m_screen_pos[row] = m_screen_pos[last];
+		m_offsets[row] = m_offsets[last];
+		m_states[row] = m_states[last];
+	}
+
+	m_ids.pop_back();
+	m_frames.pop_back();
+	m_units.pop_back();
+	m_screen_pos.pop_back();
+	m_offsets.pop_back();
+	m_states.pop_back();
+}
+
+void UnitTable::clear()
+{
+	m_ids.clear();
+	m_frames.clear();
+	m_units.clear();
+	m_screen_pos.clear();
+	m_offsets.clear();
+	m_states.clear();
+	m_index.fill(0);
+}
+
+}
@@ -0,0 +1,66 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include "d2/structs.h"
+#include "predictor.h"
+
+namespace d2gl::modules {
+
+#define UNIT_TABLE_CAPACITY 2048
+#define UNIT_TABLE_INDEX_BITS 12
+#define UNIT_TABLE_INDEX_SIZE (1 << UNIT_TABLE_INDEX_BITS)
+
+// Dense unit rows stored as parallel arrays, found by type id through a linear probing index.
+// Removing a row moves the last row into its place, so row numbers are only stable until the next remove.
+class UnitTable {
+	std::vector<uint32_t> m_ids;
+	std::vector<uint32_t> m_frames;
+	std::vector<d2::UnitAny*> m_units;
+	std::vector<glm::ivec2> m_screen_pos;
+	std::vector<glm::ivec2> m_offsets;
+	std::vector<MotionState> m_states;
+	std::array<uint16_t, UNIT_TABLE_INDEX_SIZE> m_index = { 0 };
+
+	static inline uint32_t hash(uint32_t id) { return (id * 0x9E3779B1u) >> (32 - UNIT_TABLE_INDEX_BITS); }
+	uint32_t findSlot(uint32_t id) const;
+	void eraseSlot(uint32_t slot);
+
+public:
+	UnitTable();
+	~UnitTable() = default;
+
+	int find(uint32_t id) const;
+	int insert(uint32_t id);
+	void remove(uint32_t row);
+	void clear();
+
+	inline uint32_t size() const { return (uint32_t)m_ids.size(); }
+	inline uint32_t id(uint32_t row) const { return m_ids[row]; }
+	inline uint32_t& frame(uint32_t row) { return m_frames[row]; }
+	inline d2::UnitAny*& unit(uint32_t row) { return m_units[row]; }
+	inline glm::ivec2& screenPos(uint32_t row) { return m_screen_pos[row]; }
+	inline glm::ivec2& offset(uint32_t row) { return m_offsets[row]; }
+	inline MotionState& state(uint32_t row) { return m_states[row]; }
+
+	inline const glm::ivec2* screenPositions() const { return m_screen_pos.data(); }
+};
+
+}
@@ -1,13 +1,16 @@
 unsigned short simplified_chinese_chars[] = {
-    0x4E00, 0x4E0A, 0x4E0B, 0x4E0D, 0x4E2D, 0x4E49, 0x4E8E, 0x4ECB, 0x4ECE, 0x4EF6, 0x4F1A, 0x4F38, 0x4F3C, 0x4F3D, 0x4F4D, 0x4F53,
-    0x4FDD, 0x5019, 0x503C, 0x50CF, 0x5149, 0x5165, 0x5168, 0x5185, 0x5230, 0x5236, 0x524D, 0x529F, 0x52A8, 0x5305, 0x5316, 0x534A,
-    0x5355, 0x53BB, 0x53E3, 0x53F0, 0x540C, 0x540E, 0x542F, 0x547D, 0x548C, 0x54C1, 0x5546, 0x5668, 0x56FE, 0x5728, 0x5730, 0x5782,
-    0x578B, 0x5904, 0x5927, 0x592E, 0x5931, 0x5982, 0x59CB, 0x5B57, 0x5B58, 0x5B9A, 0x5BBD, 0x5C06, 0x5C0F, 0x5C40, 0x5C45, 0x5C4F,
-    0x5DE6, 0x5E55, 0x5E73, 0x5E94, 0x5E95, 0x5EA6, 0x5F00, 0x5F0F, 0x5F3A, 0x5F84, 0x5FEB, 0x6001, 0x6027, 0x602A, 0x60AC, 0x620F,
-    0x6253, 0x627E, 0x6297, 0x62C9, 0x62EC, 0x6539, 0x653E, 0x6548, 0x6570, 0x6587, 0x65F6, 0x662F, 0x663E, 0x6655, 0x66DD, 0x66F4,
-    0x6700, 0x672A, 0x6761, 0x679C, 0x67E5, 0x6807, 0x680F, 0x6821, 0x6837, 0x684C, 0x6A21, 0x6B21, 0x6B63, 0x6B65, 0x6C34, 0x6D3B,
-    0x6D4B, 0x6D6E, 0x6DF1, 0x6E05, 0x6E38, 0x70B9, 0x7126, 0x7269, 0x72B6, 0x751F, 0x7528, 0x7684, 0x76F4, 0x7740, 0x793A, 0x7A97,
-    0x7D20, 0x7EA7, 0x7EBF, 0x7EC4, 0x7EC8, 0x7ECD, 0x7F29, 0x7F6E, 0x80FD, 0x81EA, 0x8272, 0x83DC, 0x85CF, 0x884C, 0x8868, 0x89C6,
-    0x89D2, 0x89E3, 0x8BA1, 0x8BBE, 0x8D28, 0x8DF3, 0x8F93, 0x8FC7, 0x8FD0, 0x8FD1, 0x9009, 0x901F, 0x90E8, 0x914D, 0x91C7, 0x91CF,
-    0x9501, 0x9510, 0x952F, 0x9650, 0x9690, 0x975E, 0x9762, 0x9875, 0x9879, 0x9884, 0x9891, 0x9898, 0x989C, 0x9A6C, 0x9AD8, 0x9F7F
+    0x4E00, 0x4E0A, 0x4E0B, 0x4E0D, 0x4E2D, 0x4E49, 0x4E8E, 0x4ECB, 0x4ECE, 0x4EE5, 0x4EF6, 0x4F1A, 0x4F38, 0x4F3C, 0x4F3D, 0x4F4D,
+    0x4F4E, 0x4F53, 0x4FDD, 0x4FEE, 0x5019, 0x503C, 0x505C, 0x50CF, 0x5149, 0x5165, 0x5168, 0x5185, 0x51FA, 0x51FD, 0x5206, 0x5230,
+    0x5236, 0x524D, 0x529F, 0x52A8, 0x5305, 0x5316, 0x534A, 0x5355, 0x539F, 0x53BB, 0x53CA, 0x53E3, 0x53F0, 0x5404, 0x540C, 0x540E,
+    0x542F, 0x547D, 0x548C, 0x54C1, 0x5546, 0x5668, 0x566A, 0x56FE, 0x5728, 0x5730, 0x5757, 0x5782, 0x578B, 0x589E, 0x58F0, 0x5904,
+    0x5927, 0x592E, 0x5931, 0x5982, 0x59CB, 0x5B50, 0x5B57, 0x5B58, 0x5B9A, 0x5BBD, 0x5C06, 0x5C0F, 0x5C40, 0x5C45, 0x5C4F, 0x5DE6,
+    0x5E27, 0x5E55, 0x5E73, 0x5E94, 0x5E95, 0x5EA6, 0x5F00, 0x5F0F, 0x5F3A, 0x5F55, 0x5F84, 0x5F85, 0x5FEB, 0x6001, 0x6027, 0x602A,
+    0x603B, 0x60AC, 0x620F, 0x6253, 0x627E, 0x6297, 0x62C9, 0x62EC, 0x6539, 0x653E, 0x6548, 0x6570, 0x6587, 0x65F6, 0x662F, 0x663E,
+    0x6655, 0x66DD, 0x66F4, 0x6700, 0x672A, 0x6761, 0x6790, 0x679C, 0x67D3, 0x67E5, 0x6807, 0x680F, 0x6821, 0x6837, 0x684C, 0x6A21,
+    0x6B21, 0x6B62, 0x6B63, 0x6B65, 0x6BB5, 0x6BCF, 0x6BEB, 0x6C34, 0x6CD5, 0x6D3B, 0x6D4B, 0x6D6E, 0x6DF1, 0x6E05, 0x6E32, 0x6E38,
+    0x70B9, 0x7126, 0x7269, 0x72B6, 0x7387, 0x751F, 0x7528, 0x7684, 0x76CA, 0x76F4, 0x7740, 0x793A, 0x79D2, 0x7A0B, 0x7A97, 0x7B49,
+    0x7B97, 0x7CCA, 0x7CFB, 0x7D20, 0x7EA7, 0x7EBF, 0x7EC4, 0x7EC8, 0x7ECD, 0x7ED8, 0x7EDF, 0x7F29, 0x7F6E, 0x8017, 0x80FD, 0x81EA,
+    0x8272, 0x83DC, 0x85CF, 0x884C, 0x8868, 0x89C6, 0x89D2, 0x89E3, 0x8BA1, 0x8BB0, 0x8BBE, 0x8C03, 0x8D28, 0x8D85, 0x8DF3, 0x8F93,
+    0x8FA8, 0x8FC7, 0x8FD0, 0x8FD1, 0x9009, 0x901A, 0x901F, 0x9053, 0x90E8, 0x914D, 0x91C7, 0x91CF, 0x94A9, 0x9501, 0x9510, 0x952F,
+    0x95F4, 0x9636, 0x964D, 0x9650, 0x9690, 0x975E, 0x9762, 0x9875, 0x9879, 0x9884, 0x9891, 0x9898, 0x989C, 0x9A6C, 0x9AD8, 0x9F7F
 };
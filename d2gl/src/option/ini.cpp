@@ -186,6 +186,10 @@ void saveIni()
 		"; Upscale shader.\n"
 		"; RetroArch's slang shader preset files (.slangp).\n"
 		"shader_preset=%d\n\n"
+		"; Lower the resolution of intermediate shader passes when the shader GPU time\n"
+		"; exceeds the frame budget (in milliseconds).\n"
+		"shader_dynamic_res=%s\n"
+		"shader_frame_budget=%.3f\n\n"
 		"; Color grading (LUT) (only available in glide mode).\n"
 		"; Set one of 1-%d predefined luts. 0 = game default.\n"
 		"lut=%d\n\n"
@@ -200,13 +204,17 @@ void saveIni()
 		"; Bloom effect.\n"
 		"bloom=%s\n"
 		"bloom_exposure=%.3f\n"
-		"bloom_gamma=%.3f\n\n"
+		"bloom_gamma=%.3f\n"
+		"; Bloom blur kernel (0: gaussian, 1: dual filter).\n"
+		"bloom_kernel=%d\n\n"
 		"; Stretch viewport to window size.\n"
 		"stretched_horizontal=%s\n"
 		"stretched_vertical=%s\n\n\n";
 
 	sprintf_s(buf, graphic_setting,
 		App.shader.preset.c_str(),
+		boolString(App.shader.dynamic_res.active),
+		App.shader.dynamic_res.budget.value,
 		App.lut.items.size() - 1,
 		App.lut.selected,
 		boolString(App.sharpen.active),
@@ -218,6 +226,7 @@ void saveIni()
 		boolString(App.bloom.active),
 		App.bloom.exposure.value,
 		App.bloom.gamma.value,
+		App.bloom.kernel.selected,
 		boolString(App.viewport.stretched.x),
 		boolString(App.viewport.stretched.y));
 	out_file << buf;
@@ -238,7 +247,16 @@ void saveIni()
 		"mini_map_width=%d\n"
 		"mini_map_height=%d\n\n"
 		"; D2DX's Motion Prediction.\n"
-		"motion_prediction=%s\n\n"
+		"motion_prediction=%s\n"
+		"; Motion predictor (0: d2dx, 1: alpha-beta, 2: kalman).\n"
+		"; correction: d2dx blend toward game position (out of 65536), alpha/beta: alpha-beta filter gains,\n"
+		"; process/measure noise: how much the kalman filter trusts its motion over game positions.\n"
+		"motion_predictor=%d\n"
+		"motion_correction=%d\n"
+		"motion_alpha=%.3f\n"
+		"motion_beta=%.3f\n"
+		"motion_process_noise=%.3f\n"
+		"motion_measure_noise=%.3f\n\n"
 		"; Skip the Intro videos.\n"
 		"skip_intro=%s\n\n"
 		"; Auto /nopickup option on launch (exclude 1.09d).\n"
@@ -261,6 +279,12 @@ void saveIni()
 		App.mini_map.width.value,
 		App.mini_map.height.value,
 		boolString(App.motion_prediction),
+		App.motion_predictor.type.selected,
+		App.motion_predictor.correction.value,
+		App.motion_predictor.alpha.value,
+		App.motion_predictor.beta.value,
+		App.motion_predictor.process_noise.value,
+		App.motion_predictor.measure_noise.value,
 		boolString(App.skip_intro),
 		boolString(App.no_pickup),
 		boolString(App.show_item_quantity),
@@ -275,6 +299,12 @@ void saveIni()
 		"gl_ver_minor=%d\n\n"
 		"; Use compute shader (enabling this might be better on some gpu).\n"
 		"use_compute_shader=%s\n\n"
+		"; Draw hd text, cursor and minimap quads as instances (disable if they render broken on your driver).\n"
+		"instanced_mod=%s\n\n"
+		"; Compare DDraw frame rows with previous frame and upload only changed ones (ddraw only).\n"
+		"ddraw_row_hash=%s\n\n"
+		"; Let the game draw straight into mapped upload buffers (ddraw only, requires OpenGL 4.4).\n"
+		"ddraw_zero_copy=%s\n\n"
 		"; Frame Latency (how many frames cpu generate before rendering).\n"
 		"; Set 1-5 (increasing this value notice less frame stutter but introduces more input lag).\n"
 		"frame_latency=%d\n\n"
@@ -287,6 +317,9 @@ void saveIni()
 		App.gl_ver.x,
 		App.gl_ver.y,
 		boolString(App.use_compute_shader),
+		boolString(App.instanced_mod),
+		boolString(App.ddraw_row_hash),
+		boolString(App.ddraw_zero_copy),
 		App.frame_latency,
 		App.dlls_early.c_str(),
 		App.dlls_late.c_str());
@@ -335,6 +368,8 @@ void loadIni()
 		App.background_fps.range.value = getInt("Screen", "background_fps_value", App.background_fps.range.value, App.background_fps.range.min, App.background_fps.range.max);
 
 		App.shader.preset = getString("Graphic", "shader_preset", App.shader.preset);
+		App.shader.dynamic_res.active = getBool("Graphic", "shader_dynamic_res", App.shader.dynamic_res.active);
+		App.shader.dynamic_res.budget.value = getFloat("Graphic", "shader_frame_budget", App.shader.dynamic_res.budget);
 		App.lut.selected = getInt("Graphic", "lut", App.lut.selected, 0, App.lut.items.size() - 1);
 		App.fxaa.active = getBool("Graphic", "fxaa", App.fxaa.active);
 		App.fxaa.presets.selected = getInt("Graphic", "fxaa_preset", App.fxaa.presets.selected, 0, 2);
@@ -347,6 +382,7 @@ void loadIni()
 		App.bloom.active = getBool("Graphic", "bloom", App.bloom.active);
 		App.bloom.exposure.value = getFloat("Graphic", "bloom_exposure", App.bloom.exposure);
 		App.bloom.gamma.value = getFloat("Graphic", "bloom_gamma", App.bloom.gamma);
+		App.bloom.kernel.selected = getInt("Graphic", "bloom_kernel", App.bloom.kernel.selected, 0, 1);
 
 		App.viewport.stretched.x = getBool("Graphic", "stretched_horizontal", App.viewport.stretched.x);
 		App.viewport.stretched.y = getBool("Graphic", "stretched_vertical", App.viewport.stretched.y);
@@ -364,6 +400,12 @@ void loadIni()
 		App.mini_map.height.value = getInt("Feature", "mini_map_height", App.mini_map.height.value, App.mini_map.height.min, App.mini_map.height.max);
 
 		App.motion_prediction = getBool("Feature", "motion_prediction", App.motion_prediction);
+		App.motion_predictor.type.selected = getInt("Feature", "motion_predictor", App.motion_predictor.type.selected, 0, 2);
+		App.motion_predictor.correction.value = getInt("Feature", "motion_correction", App.motion_predictor.correction.value, App.motion_predictor.correction.min, App.motion_predictor.correction.max);
+		App.motion_predictor.alpha.value = getFloat("Feature", "motion_alpha", App.motion_predictor.alpha);
+		App.motion_predictor.beta.value = getFloat("Feature", "motion_beta", App.motion_predictor.beta);
+		App.motion_predictor.process_noise.value = getFloat("Feature", "motion_process_noise", App.motion_predictor.process_noise);
+		App.motion_predictor.measure_noise.value = getFloat("Feature", "motion_measure_noise", App.motion_predictor.measure_noise);
 		App.skip_intro = getBool("Feature", "skip_intro", App.skip_intro);
 		App.no_pickup = getBool("Feature", "no_pickup", App.no_pickup);
 		App.show_item_quantity = getBool("Feature", "show_item_quantity", App.show_item_quantity);
@@ -375,6 +417,9 @@ void loadIni()
 		App.gl_ver.y = App.gl_ver.x == 3 ? 3 : App.gl_ver.y;
 
 		App.use_compute_shader = getBool("Other", "use_compute_shader", App.use_compute_shader);
+		App.instanced_mod = getBool("Other", "instanced_mod", App.instanced_mod);
+		App.ddraw_row_hash = getBool("Other", "ddraw_row_hash", App.ddraw_row_hash);
+		App.ddraw_zero_copy = getBool("Other", "ddraw_zero_copy", App.ddraw_zero_copy);
 		App.frame_latency = getInt("Other", "frame_latency", App.frame_latency, 1, 5);
 
 		App.dlls_early = getString("Other", "load_dlls_early", App.dlls_early);
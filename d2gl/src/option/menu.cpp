@@ -19,11 +19,14 @@
 #include "pch.h"
 #include "menu.h"
 #include "d2/common.h"
+#include "graphic/gpu_timer.h"
+#include "graphic/upscaler.h"
 #include "helpers.h"
 #include "ini.h"
 #include "modules/hd_text.h"
 #include "modules/mini_map.h"
 #include "modules/motion_prediction.h"
+#include "profiler.h"
 #include "win32.h"
 
 namespace d2gl::option {
@@ -340,6 +343,16 @@ void Menu::draw()
 			drawDescription("RetroArch's slang shader preset files (.slangp).", m_colors[Color::Gray]);
 			childBegin("##w3", true);
 			drawSeparator();
+			drawCheckbox_m("动态分辨率", App.shader.dynamic_res.active, "", dynamic_res)
+				saveBool("Graphic", "shader_dynamic_res", App.shader.dynamic_res.active);
+			ImGui::BeginDisabled(!App.shader.dynamic_res.active);
+				drawSlider_m(float, "", App.shader.dynamic_res.budget, "%.1f ms", "", dynamic_res_budget)
+					saveFloat("Graphic", "shader_frame_budget", App.shader.dynamic_res.budget.value);
+				char dynamic_res_desc[100] = { 0 };
+				sprintf_s(dynamic_res_desc, "超出预算时降低中间通道分辨率 (%.0f%%, %.2f ms)", Upscaler::Instance().getDynamicScale() * 100.0f, Upscaler::Instance().getGpuTime());
+				drawDescription(dynamic_res_desc, m_colors[Color::Gray], 12);
+			ImGui::EndDisabled();
+			drawSeparator();
 			drawCheckbox_m("光线锐化", App.sharpen.active, "", sharpen)
 				saveBool("Graphic", "sharpen", App.sharpen.active);
 			ImGui::BeginDisabled(!App.sharpen.active);
@@ -375,6 +388,8 @@ void Menu::draw()
 					drawSlider_m(float, "", App.bloom.gamma, "%.3f", "", bloom_gamma)
 						saveFloat("Graphic", "bloom_gamma", App.bloom.gamma.value);
 					drawDescription("伽马设置", m_colors[Color::Gray], 12);
+					drawCombo_m("", App.bloom.kernel, "模糊算法", false, 17, bloom_kernel)
+						saveInt("Graphic", "bloom_kernel", App.bloom.kernel.selected);
 				ImGui::EndDisabled();
 			ImGui::EndDisabled();
 			drawSeparator();
@@ -451,6 +466,24 @@ void Menu::draw()
 					modules::MotionPrediction::Instance().toggle(App.motion_prediction);
 					saveBool("Feature", "motion_prediction", App.motion_prediction);
 				}
+				ImGui::BeginDisabled(!App.motion_prediction);
+					drawCombo_m("", App.motion_predictor.type, "预测算法", false, 17, motion_predictor)
+						saveInt("Feature", "motion_predictor", App.motion_predictor.type.selected);
+					if (App.motion_predictor.type.selected == 0) {
+						drawSlider_m(int, "", App.motion_predictor.correction, "%d", "修正系数 (/65536)", motion_correction)
+							saveInt("Feature", "motion_correction", App.motion_predictor.correction.value);
+					} else if (App.motion_predictor.type.selected == 1) {
+						drawSlider_m(float, "", App.motion_predictor.alpha, "%.3f", "位置增益 (Alpha)", motion_alpha)
+							saveFloat("Feature", "motion_alpha", App.motion_predictor.alpha.value);
+						drawSlider_m(float, "", App.motion_predictor.beta, "%.3f", "速度增益 (Beta)", motion_beta)
+							saveFloat("Feature", "motion_beta", App.motion_predictor.beta.value);
+					} else {
+						drawSlider_m(float, "", App.motion_predictor.process_noise, "%.2f", "过程噪声", motion_process_noise)
+							saveFloat("Feature", "motion_process_noise", App.motion_predictor.process_noise.value);
+						drawSlider_m(float, "", App.motion_predictor.measure_noise, "%.3f", "测量噪声", motion_measure_noise)
+							saveFloat("Feature", "motion_measure_noise", App.motion_predictor.measure_noise.value);
+					}
+				ImGui::EndDisabled();
 			ImGui::EndDisabled();
 			drawSeparator();
 			drawCheckbox_m("跳过介绍", App.skip_intro, "启动时自动跳过介绍视频", skip_intro)
@@ -470,6 +503,70 @@ void Menu::draw()
 			childEnd();
 			tabEnd();
 		}
+		if (tabBegin("性能", 4, &active_tab)) {
+			childBegin("##p0");
+			drawCheckbox_m("性能分析", App.profile, "统计每帧 D2 绘制钩子, 模块和渲染线程的 CPU 耗时, 以及各渲染阶段的 GPU 耗时", profile)
+				Profiler::Instance().toggle(App.profile);
+			ImGui::BeginDisabled(!App.profile);
+			const bool capturing = Profiler::Instance().isCapturing();
+			if (drawButton(capturing ? "停止记录" : "记录 CSV / Chrome Trace", { 260.0f, 0.0f })) {
+				if (capturing)
+					Profiler::Instance().stopCapture();
+				else
+					Profiler::Instance().startCapture(App.profile_file);
+			}
+			ImGui::EndDisabled();
+			drawDescription(("保存到 " + App.profile_file + ".csv 和 " + App.profile_file + ".json").c_str(), m_colors[Color::Gray]);
+			drawSeparator();
+			ImGui::PushFont(m_fonts[15]);
+			if (ImGui::BeginTable("##profile", 3, ImGuiTableFlags_RowBg)) {
+				ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("调用/帧", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+				ImGui::TableSetupColumn("毫秒/帧", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+				ImGui::TableHeadersRow();
+
+				const auto stats = Profiler::Instance().getStats();
+				drawProfileRow("帧", stats.frame_ms);
+				drawProfileRow("D2 钩子", stats.hooks_ms);
+				drawProfileRow("  D2 原函数", stats.d2_ms);
+				drawProfileRow("等待渲染线程", stats.wait_ms);
+				drawProfileRow("渲染线程", stats.render_ms);
+				for (size_t i = 0; i < stats.modules.size(); i++)
+					drawProfileRow(Profiler::getModuleName((ProfileModule)i), stats.modules[i].ms, stats.modules[i].calls);
+				for (size_t i = 0; i < stats.hooks.size(); i++) {
+					if (stats.hooks[i].calls > 0.0f)
+						drawProfileRow(Profiler::getHookName((ProfileHook)i), stats.hooks[i].ms, stats.hooks[i].calls);
+				}
+				ImGui::EndTable();
+			}
+			drawSeparator();
+			if (ImGui::BeginTable("##profile_gpu", 3, ImGuiTableFlags_RowBg)) {
+				ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthStretch);
+				ImGui::TableSetupColumn("", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+				ImGui::TableSetupColumn("GPU 毫秒/帧", ImGuiTableColumnFlags_WidthFixed, 100.0f);
+				ImGui::TableHeadersRow();
+
+				const auto& gpu_stats = GpuTimer::Instance().getStats();
+				drawProfileRow("GPU 总计", gpu_stats.total_ms);
+				for (size_t i = 0; i < gpu_stats.stages.size(); i++) {
+					drawProfileRow(GpuTimer::getStageName((GpuStage)i), gpu_stats.stages[i]);
+					if ((GpuStage)i != GpuStage::Upscaler)
+						continue;
+
+					const auto& passes = Upscaler::Instance().getPasses();
+					for (size_t j = 0; j < passes.size(); j++) {
+						if (passes[j].skip)
+							continue;
+						const std::string pass_name = "  #" + std::to_string(j) + " " + passes[j].label;
+						drawProfileRow(pass_name.c_str(), passes[j].gpu_time);
+					}
+				}
+				ImGui::EndTable();
+			}
+			ImGui::PopFont();
+			childEnd();
+			tabEnd();
+		}
 #ifdef _HDTEXT
 		if (tabBegin("HD Text", 3, &active_tab)) {
 			ImGuiIO& io = ImGui::GetIO();
@@ -525,7 +622,7 @@ void Menu::draw()
 		ImGui::EndTabBar();
 	}
 	ImGui::PopFont();
-	if (active_tab != 3) {
+	if (active_tab < 3) {
 		ImGui::SetCursorPos({ 16.0f, 500.0f });
 		ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, { 0.0f, 0.0f });
 		ImGui::PushStyleVar(ImGuiStyleVar_FrameBorderSize, 0.0f);
@@ -737,6 +834,18 @@ bool Menu::drawButton(const char* label, const ImVec2& btn_size, int size)
 	return ret;
 }
 
+void Menu::drawProfileRow(const char* name, float ms, float calls)
+{
+	ImGui::TableNextRow();
+	ImGui::TableNextColumn();
+	ImGui::TextColored(m_colors[Color::Orange], "%s", name);
+	ImGui::TableNextColumn();
+	if (calls >= 0.0f)
+		ImGui::Text("%.1f", calls);
+	ImGui::TableNextColumn();
+	ImGui::Text("%.3f", ms);
+}
+
 void Menu::drawSeparator(float y_padd, float alpha)
 {
 	ImGui::Dummy({ 0.0f, y_padd - 1.0f });
@@ -67,6 +67,7 @@ class Menu {
 	void drawInput2(const std::string& id, const char* desc, glm::ivec2* input, glm::ivec2 min = { 0, 0 }, glm::ivec2 max = { 10000, 10000 });
 
 	bool drawButton(const char* label, const ImVec2& btn_size = { 0.0f, 0.0f }, int size = 17);
+	void drawProfileRow(const char* name, float ms, float calls = -1.0f);
 	void drawSeparator(float y_padd = 5.0f, float alpha = 1.0f);
 	void drawLabel(const char* title, const ImVec4& color, int size = 17);
 	void drawDescription(const char* desc, const ImVec4& color, int size = 14);
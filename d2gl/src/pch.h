@@ -28,12 +28,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <bitset>
 #include <chrono>
+#include <condition_variable>
 #include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <map>
+#include <mutex>
 #include <numeric>
 #include <thread>
 #include <unordered_map>
@@ -0,0 +1,334 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "pch.h"
+#include "profiler.h"
+
+namespace d2gl {
+
+namespace {
+
+const char* g_hook_names[] = {
+	"Image",
+	"PerspectiveImage",
+	"ShiftedImage",
+	"VerticalCropImage",
+	"ClippedImage",
+	"ImageFast",
+	"Shadow",
+	"SolidRect",
+	"Line",
+	"GroundTile",
+	"WallTile",
+	"TransWallTile",
+	"ShadowTile",
+	"NormalText",
+	"NormalTextEx",
+	"FramedText",
+	"RectangledText",
+	"TextSize",
+};
+
+const char* g_module_names[] = {
+	"HDText",
+	"MotionPrediction",
+};
+
+static_assert(sizeof(g_hook_names) / sizeof(g_hook_names[0]) == (size_t)ProfileHook::Count);
+static_assert(sizeof(g_module_names) / sizeof(g_module_names[0]) == (size_t)ProfileModule::Count);
+
+inline void addCounters(ProfileFrame& sum, const ProfileFrame& frame)
+{
+	for (size_t i = 0; i < sum.hooks.size(); i++) {
+		sum.hooks[i].calls += frame.hooks[i].calls;
+		sum.hooks[i].cycles += frame.hooks[i].cycles;
+	}
+	for (size_t i = 0; i < sum.modules.size(); i++) {
+		sum.modules[i].calls += frame.modules[i].calls;
+		sum.modules[i].cycles += frame.modules[i].cycles;
+	}
+	sum.hook_cycles += frame.hook_cycles;
+	sum.hooked_module_cycles += frame.hooked_module_cycles;
+	sum.wait_cycles += frame.wait_cycles;
+	sum.render_cycles += frame.render_cycles;
+	sum.frame_cycles += frame.frame_cycles;
+}
+
+}
+
+Profiler::Profiler()
+{
+	LARGE_INTEGER qpf;
+	QueryPerformanceFrequency(&qpf);
+	m_qpc_per_ms = double(qpf.QuadPart) / 1000.0;
+}
+
+Profiler::~Profiler()
+{
+	stopCapture();
+}
+
+void Profiler::toggle(bool active)
+{
+	if (!active)
+		stopCapture();
+
+	m_active = active;
+}
+
+// TSC rate measured against QPC since profiling started, the longer the baseline the better the estimate.
+void Profiler::calibrate(uint64_t tsc)
+{
+	LARGE_INTEGER qpc;
+	QueryPerformanceCounter(&qpc);
+
+	if (!m_base_tsc) {
+		m_base_tsc = tsc;
+		m_base_qpc = qpc.QuadPart;
+		return;
+	}
+
+	const double ms = double(qpc.QuadPart - m_base_qpc) / m_qpc_per_ms;
+	if (ms > 0.0)
+		m_cycles_per_ms = double(tsc - m_base_tsc) / ms;
+}
+
+double Profiler::toMs(uint64_t cycles)
+{
+	return m_cycles_per_ms > 0.0 ? double(cycles) / m_cycles_per_ms : 0.0;
+}
+
+double Profiler::toUs(uint64_t tsc)
+{
+	return m_cycles_per_ms > 0.0 ? double((int64_t)(tsc - m_base_tsc)) * 1000.0 / m_cycles_per_ms : 0.0;
+}
+
+bool Profiler::startCapture(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_csv.is_open())
+		return true;
+
+	m_csv.open(name + ".csv", std::ios::trunc);
+	m_trace.open(name + ".json", std::ios::trunc);
+	if (!m_csv.is_open() || !m_trace.is_open()) {
+		m_csv.close();
+		m_trace.close();
+		error_log("Profiler: failed to open %s capture files.", name.c_str());
+		return false;
+	}
+
+	m_csv << "frame,frame_ms,hooks_ms,d2_ms,wait_ms,render_ms";
+	for (auto module_name : g_module_names)
+		m_csv << "," << module_name << "_calls," << module_name << "_ms";
+	for (auto hook_name : g_hook_names)
+		m_csv << "," << hook_name << "_calls," << hook_name << "_ms";
+	m_csv << "\n";
+
+	m_trace << "{\"traceEvents\":[\n";
+	m_trace_first = true;
+	writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Game\"}}", (int)ProfileThread::Game);
+	writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Render\"}}", (int)ProfileThread::Render);
+	writeEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"GPU\"}}", (int)ProfileThread::Gpu);
+
+	m_spans.clear();
+	m_frame_count = 0;
+	trace_log("Profiler: capturing to %s.csv / %s.json", name.c_str(), name.c_str());
+
+	return true;
+}
+
+void Profiler::stopCapture()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_csv.is_open())
+		return;
+
+	m_trace << "\n]}\n";
+	m_trace.close();
+	m_csv.close();
+	m_spans.clear();
+	trace_log("Profiler: captured %u frames.", m_frame_count);
+}
+
+bool Profiler::isCapturing()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_csv.is_open();
+}
+
+void Profiler::addWait(uint64_t start, uint64_t end)
+{
+	m_frame.wait_cycles += end - start;
+	addSpan("Wait", ProfileThread::Game, start, end);
+}
+
+void Profiler::addRender(uint64_t start, uint64_t end)
+{
+	m_render_cycles += end - start;
+	addSpan("Render", ProfileThread::Render, start, end);
+}
+
+void Profiler::addSpan(const char* name, ProfileThread thread, uint64_t start, uint64_t end)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_trace.is_open())
+		m_spans.push_back({ name, thread, start, end });
+}
+
+void Profiler::addGpuSpan(const char* name, uint64_t start, float offset_ms, float ms)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_trace.is_open())
+		m_spans.push_back({ name, ProfileThread::Gpu, start, start, offset_ms, ms });
+}
+
+void Profiler::endFrame()
+{
+	if (!m_active) {
+		if (m_frame_start) {
+			m_frame = {};
+			m_sum = {};
+			m_sum_count = 0;
+			m_frame_start = 0;
+			m_base_tsc = 0;
+			m_cycles_per_ms = 0.0;
+			m_render_cycles = 0;
+		}
+		return;
+	}
+
+	const uint64_t now = __rdtsc();
+	calibrate(now);
+
+	if (m_frame_start && m_cycles_per_ms > 0.0) {
+		m_frame.frame_cycles = now - m_frame_start;
+		m_frame.render_cycles = m_render_cycles.exchange(0);
+		addCounters(m_sum, m_frame);
+		m_sum_count++;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_csv.is_open())
+			writeFrame(m_frame);
+
+		if (m_sum_count == PROFILER_AVERAGE_FRAMES) {
+			const float count = (float)m_sum_count;
+			m_stats.frame_ms = (float)toMs(m_sum.frame_cycles) / count;
+			m_stats.hooks_ms = (float)toMs(m_sum.hook_cycles) / count;
+			m_stats.d2_ms = (float)toMs(m_sum.hook_cycles - m_sum.hooked_module_cycles) / count;
+			m_stats.wait_ms = (float)toMs(m_sum.wait_cycles) / count;
+			m_stats.render_ms = (float)toMs(m_sum.render_cycles) / count;
+			for (size_t i = 0; i < m_sum.hooks.size(); i++)
+				m_stats.hooks[i] = { m_sum.hooks[i].calls / count, (float)toMs(m_sum.hooks[i].cycles) / count };
+			for (size_t i = 0; i < m_sum.modules.size(); i++)
+				m_stats.modules[i] = { m_sum.modules[i].calls / count, (float)toMs(m_sum.modules[i].cycles) / count };
+
+			m_sum = {};
+			m_sum_count = 0;
+		}
+	} else {
+		m_render_cycles = 0;
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_spans.clear();
+	}
+
+	m_frame = {};
+	m_frame_start = now;
+}
+
+void Profiler::writeFrame(const ProfileFrame& frame)
+{
+	char buf[256];
+	snprintf(buf, sizeof(buf), "%u,%.4f,%.4f,%.4f,%.4f,%.4f", m_frame_count, toMs(frame.frame_cycles), toMs(frame.hook_cycles), toMs(frame.hook_cycles - frame.hooked_module_cycles), toMs(frame.wait_cycles), toMs(frame.render_cycles));
+	m_csv << buf;
+	for (const auto& counter : frame.modules) {
+		snprintf(buf, sizeof(buf), ",%u,%.4f", counter.calls, toMs(counter.cycles));
+		m_csv << buf;
+	}
+	for (const auto& counter : frame.hooks) {
+		snprintf(buf, sizeof(buf), ",%u,%.4f", counter.calls, toMs(counter.cycles));
+		m_csv << buf;
+	}
+	m_csv << "\n";
+
+	const double start = toUs(m_frame_start);
+	writeEvent("{\"name\":\"Frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%u}}", (int)ProfileThread::Game, start, toMs(frame.frame_cycles) * 1000.0, m_frame_count);
+
+	std::string args = "";
+	for (size_t i = 0; i < frame.modules.size(); i++) {
+		snprintf(buf, sizeof(buf), "\"%s\":%.4f,", g_module_names[i], toMs(frame.modules[i].cycles));
+		args += buf;
+	}
+	snprintf(buf, sizeof(buf), "\"D2\":%.4f", toMs(frame.hook_cycles - frame.hooked_module_cycles));
+	args += buf;
+	writeEvent("{\"name\":\"Modules (ms)\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{%s}}", start, args.c_str());
+
+	args = "";
+	for (size_t i = 0; i < frame.hooks.size(); i++) {
+		if (!frame.hooks[i].calls)
+			continue;
+		snprintf(buf, sizeof(buf), "%s\"%s\":%.4f", args.empty() ? "" : ",", g_hook_names[i], toMs(frame.hooks[i].cycles));
+		args += buf;
+	}
+	writeEvent("{\"name\":\"Hooks (ms)\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{%s}}", start, args.c_str());
+
+	for (const auto& span : m_spans) {
+		if (span.start < m_base_tsc)
+			continue;
+
+		const double ts = toUs(span.start) + span.gpu_offset_ms * 1000.0;
+		const double dur = span.thread == ProfileThread::Gpu ? span.gpu_ms * 1000.0 : toMs(span.end - span.start) * 1000.0;
+		writeEvent("{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", span.name, (int)span.thread, ts, dur);
+	}
+	m_spans.clear();
+
+	m_frame_count++;
+}
+
+void Profiler::writeEvent(const char* fmt, ...)
+{
+	char buf[2048];
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+
+	if (!m_trace_first)
+		m_trace << ",\n";
+	m_trace << buf;
+	m_trace_first = false;
+}
+
+ProfileStats Profiler::getStats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+const char* Profiler::getHookName(ProfileHook hook)
+{
+	return g_hook_names[(size_t)hook];
+}
+
+const char* Profiler::getModuleName(ProfileModule module)
+{
+	return g_module_names[(size_t)module];
+}
+
+}
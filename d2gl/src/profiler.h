@@ -0,0 +1,222 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#pragma once
+
+#include <intrin.h>
+
+namespace d2gl {
+
+#define PROFILER_AVERAGE_FRAMES 60
+
+enum class ProfileHook : uint8_t {
+	Image,
+	PerspectiveImage,
+	ShiftedImage,
+	VerticalCropImage,
+	ClippedImage,
+	ImageFast,
+	Shadow,
+	SolidRect,
+	Line,
+	GroundTile,
+	WallTile,
+	TransWallTile,
+	ShadowTile,
+	NormalText,
+	NormalTextEx,
+	FramedText,
+	RectangledText,
+	TextSize,
+	Count,
+};
+
+enum class ProfileModule : uint8_t {
+	HDText,
+	MotionPrediction,
+	Count,
+};
+
+enum class ProfileThread : uint8_t {
+	Game = 1,
+	Render,
+	Gpu,
+};
+
+struct ProfileCounter {
+	uint32_t calls = 0;
+	uint64_t cycles = 0;
+};
+
+// Game thread cycles of one frame. hook_cycles only counts outermost hooks and
+// hooked_module_cycles the module time spent inside them, the rest of a hook is the original D2 call.
+struct ProfileFrame {
+	std::array<ProfileCounter, (size_t)ProfileHook::Count> hooks;
+	std::array<ProfileCounter, (size_t)ProfileModule::Count> modules;
+	uint64_t hook_cycles = 0;
+	uint64_t hooked_module_cycles = 0;
+	uint64_t wait_cycles = 0;
+	uint64_t render_cycles = 0;
+	uint64_t frame_cycles = 0;
+};
+
+struct ProfileEntry {
+	float calls = 0.0f;
+	float ms = 0.0f;
+};
+
+// Per frame averages over the last PROFILER_AVERAGE_FRAMES frames.
+struct ProfileStats {
+	float frame_ms = 0.0f;
+	float hooks_ms = 0.0f;
+	float d2_ms = 0.0f;
+	float wait_ms = 0.0f;
+	float render_ms = 0.0f;
+	std::array<ProfileEntry, (size_t)ProfileHook::Count> hooks;
+	std::array<ProfileEntry, (size_t)ProfileModule::Count> modules;
+};
+
+struct ProfileSpan {
+	const char* name;
+	ProfileThread thread;
+	uint64_t start;
+	uint64_t end;
+	float gpu_offset_ms = 0.0f;
+	float gpu_ms = 0.0f;
+};
+
+class Profiler {
+	std::atomic_bool m_active = false;
+	ProfileFrame m_frame;
+	ProfileFrame m_sum;
+	uint32_t m_sum_count = 0;
+	uint32_t m_hook_depth = 0;
+	uint32_t m_module_depth = 0;
+	std::atomic_uint64_t m_render_cycles = 0;
+
+	uint64_t m_frame_start = 0;
+	uint64_t m_base_tsc = 0;
+	int64_t m_base_qpc = 0;
+	double m_qpc_per_ms = 0.0;
+	double m_cycles_per_ms = 0.0;
+
+	std::mutex m_mutex;
+	ProfileStats m_stats;
+	std::vector<ProfileSpan> m_spans;
+	std::ofstream m_csv;
+	std::ofstream m_trace;
+	bool m_trace_first = true;
+	uint32_t m_frame_count = 0;
+
+	Profiler();
+	~Profiler();
+
+	void calibrate(uint64_t tsc);
+	double toMs(uint64_t cycles);
+	double toUs(uint64_t tsc);
+	void writeFrame(const ProfileFrame& frame);
+	void writeEvent(const char* fmt, ...);
+
+	friend class ProfileScope;
+
+public:
+	static Profiler& Instance()
+	{
+		static Profiler instance;
+		return instance;
+	}
+
+	inline bool isActive() { return m_active; }
+	void toggle(bool active);
+
+	bool startCapture(const std::string& name);
+	void stopCapture();
+	bool isCapturing();
+
+	void addWait(uint64_t start, uint64_t end);
+	void addRender(uint64_t start, uint64_t end);
+	void addSpan(const char* name, ProfileThread thread, uint64_t start, uint64_t end);
+	void addGpuSpan(const char* name, uint64_t start, float offset_ms, float ms);
+	void endFrame();
+
+	ProfileStats getStats();
+
+	static const char* getHookName(ProfileHook hook);
+	static const char* getModuleName(ProfileModule module);
+};
+
+// Scoped TSC timer for the game thread. Module time is only taken by the outermost module scope.
+class ProfileScope {
+	enum class Kind : uint8_t {
+		None,
+		Hook,
+		Module,
+		NestedModule,
+	};
+
+	ProfileCounter* m_counter = nullptr;
+	uint64_t m_start = 0;
+	Kind m_kind = Kind::None;
+
+public:
+	ProfileScope(ProfileHook hook)
+	{
+		auto& profiler = Profiler::Instance();
+		if (profiler.m_active) {
+			m_kind = Kind::Hook;
+			m_counter = &profiler.m_frame.hooks[(size_t)hook];
+			profiler.m_hook_depth++;
+			m_start = __rdtsc();
+		}
+	}
+
+	ProfileScope(ProfileModule module)
+	{
+		auto& profiler = Profiler::Instance();
+		if (profiler.m_active) {
+			m_kind = profiler.m_module_depth++ ? Kind::NestedModule : Kind::Module;
+			m_counter = &profiler.m_frame.modules[(size_t)module];
+			m_start = __rdtsc();
+		}
+	}
+
+	~ProfileScope()
+	{
+		if (m_kind == Kind::None)
+			return;
+
+		const uint64_t cycles = __rdtsc() - m_start;
+		auto& profiler = Profiler::Instance();
+		auto& frame = profiler.m_frame;
+
+		if (m_kind == Kind::Hook) {
+			m_counter->calls++;
+			m_counter->cycles += cycles;
+			if (--profiler.m_hook_depth == 0)
+				frame.hook_cycles += cycles;
+		} else if (--profiler.m_module_depth == 0) {
+			m_counter->calls++;
+			m_counter->cycles += cycles;
+			if (profiler.m_hook_depth)
+				frame.hooked_module_cycles += cycles;
+		}
+	}
+};
+
+}
@@ -167,8 +167,10 @@ LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 			if (wParam == SC_MAXIMIZE)
 				return 0;
 
-			if (wParam == SC_CLOSE)
+			if (wParam == SC_CLOSE) {
+				dllShutdown();
 				exit(0);
+			}
 
 			if (wParam == SC_KEYMENU)
 				return 0;
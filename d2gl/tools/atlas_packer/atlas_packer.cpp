@@ -0,0 +1,169 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+// Converts an HD text atlas folder (data.csv + <page>.png) into data.bin.
+//
+// Build (VS developer prompt):
+//   cl /std:c++20 /O2 /EHsc /I..\..\src\modules\hd_text /I..\..\vendor\include atlas_packer.cpp
+//
+// Usage:
+//   atlas_packer <atlas_dir> [--deflate]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb/stb_image.h"
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb/stb_image_write.h"
+
+#include "atlas_format.h"
+
+using namespace d2gl;
+
+struct Page {
+	std::vector<uint8_t> data;
+	uint16_t width = 0;
+	uint16_t height = 0;
+	AtlasPageFormat format = AtlasPageFormat::RGBA8;
+};
+
+std::vector<std::string> splitToVector(const std::string& str, char delimeter)
+{
+	std::vector<std::string> segments = { "" };
+	for (auto& c : str) {
+		if (c == delimeter)
+			segments.push_back("");
+		else if (c != '\r')
+			segments.back().push_back(c);
+	}
+
+	return segments;
+}
+
+bool loadPage(const std::filesystem::path& file_path, bool deflate, Page& page)
+{
+	int width, height, bit;
+	stbi_set_flip_vertically_on_load(1);
+	uint8_t* pixels = stbi_load(file_path.string().c_str(), &width, &height, &bit, 4);
+	if (!pixels) {
+		printf("Could not load %s\n", file_path.string().c_str());
+		return false;
+	}
+
+	page.width = (uint16_t)width;
+	page.height = (uint16_t)height;
+
+	const int size = width * height * 4;
+	if (deflate) {
+		int out_size = 0;
+		uint8_t* out = stbi_zlib_compress(pixels, size, &out_size, 8);
+		page.data.assign(out, out + out_size);
+		page.format = AtlasPageFormat::Deflate;
+		free(out);
+	} else
+		page.data.assign(pixels, pixels + size);
+
+	stbi_image_free(pixels);
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		printf("Usage: atlas_packer <atlas_dir> [--deflate]\n");
+		return 1;
+	}
+
+	const std::filesystem::path dir = argv[1];
+	const bool deflate = argc > 2 && std::string(argv[2]) == "--deflate";
+
+	std::ifstream csv(dir / "data.csv");
+	if (!csv.is_open()) {
+		printf("Could not open %s\n", (dir / "data.csv").string().c_str());
+		return 1;
+	}
+
+	std::vector<Page> pages;
+	std::vector<AtlasGlyph> glyphs;
+	int atlas_index = -1;
+
+	for (std::string line; std::getline(csv, line, '\n');) {
+		auto cols = splitToVector(line, ',');
+		if (cols.size() < 11)
+			continue;
+
+		auto index = std::atoi(cols[0].c_str());
+		if (atlas_index < index) {
+			Page page;
+			if (!loadPage(dir / (cols[0] + ".png"), deflate, page))
+				return 1;
+
+			pages.push_back(std::move(page));
+			atlas_index = index;
+		}
+
+		// Same math as GlyphSet::loadCSV, so both paths produce identical glyphs.
+		const float coords[4] = { std::stof(cols[7]), std::stof(cols[8]), std::stof(cols[9]), std::stof(cols[10]) };
+		const float bounds[4] = { std::stof(cols[3]), std::stof(cols[4]), std::stof(cols[5]), std::stof(cols[6]) };
+
+		AtlasGlyph glyph;
+		glyph.code = (uint32_t)(wchar_t)std::atoi(cols[1].c_str());
+		glyph.page = (uint32_t)pages.size() - 1;
+		glyph.advance = std::stof(cols[2]) * 32.0f;
+		glyph.size[0] = coords[2] - coords[0];
+		glyph.size[1] = coords[3] - coords[1];
+		glyph.offset[0] = bounds[0] * 32.0f;
+		glyph.offset[1] = -bounds[3] * 32.0f;
+		for (int i = 0; i < 4; i++)
+			glyph.tex_coord[i] = coords[i] / 1024.0f;
+		glyphs.push_back(glyph);
+	}
+
+	AtlasHeader header = { ATLAS_MAGIC, ATLAS_VERSION, (uint32_t)pages.size(), (uint32_t)glyphs.size() };
+
+	std::vector<AtlasPage> page_table;
+	uint32_t offset = sizeof(AtlasHeader) + (uint32_t)(pages.size() * sizeof(AtlasPage) + glyphs.size() * sizeof(AtlasGlyph));
+	for (auto& page : pages) {
+		page_table.push_back({ offset, (uint32_t)page.data.size(), page.width, page.height, page.format });
+		offset += (uint32_t)page.data.size();
+	}
+
+	std::ofstream out(dir / "data.bin", std::ios::binary);
+	out.write((const char*)&header, sizeof(header));
+	out.write((const char*)page_table.data(), page_table.size() * sizeof(AtlasPage));
+	out.write((const char*)glyphs.data(), glyphs.size() * sizeof(AtlasGlyph));
+	for (auto& page : pages)
+		out.write((const char*)page.data.data(), page.data.size());
+
+	if (!out.good()) {
+		printf("Could not write %s\n", (dir / "data.bin").string().c_str());
+		return 1;
+	}
+
+	printf("%s: %d glyphs, %d pages, %d bytes.\n", (dir / "data.bin").string().c_str(), (int)glyphs.size(), (int)pages.size(), offset);
+	return 0;
+}
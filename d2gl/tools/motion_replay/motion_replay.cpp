@@ -0,0 +1,82 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+// Replays a motion recording (-motionrec) through every predictor and prints the error, jitter and cost of each.
+//
+// Build (VS developer prompt):
+//   cl /std:c++20 /O2 /EHsc /I. /I..\..\src\modules\motion_prediction /I..\..\vendor\include motion_replay.cpp ..\..\src\modules\motion_prediction\predictor.cpp ..\..\src\modules\motion_prediction\motion_replay.cpp ..\..\src\modules\motion_prediction\particle_tracker.cpp
+//
+// Usage:
+//   motion_replay <recording> [--correction n] [--alpha x] [--beta x] [--process-noise x] [--measure-noise x]
+
+#include "pch.h"
+#include "motion_replay.h"
+
+using namespace d2gl::modules;
+
+int main(int argc, char** argv)
+{
+	if (argc < 2) {
+		printf("Usage: motion_replay <recording> [--correction n] [--alpha x] [--beta x] [--process-noise x] [--measure-noise x]\n");
+		return 1;
+	}
+
+	// Same units as the ini / menu values, converted like MotionPrediction::getPredictorParams.
+	PredictorParams params;
+	for (int i = 2; i + 1 < argc; i += 2) {
+		const std::string arg = argv[i];
+		const float value = (float)atof(argv[i + 1]);
+		if (arg == "--correction")
+			params.correction = (int32_t)value;
+		else if (arg == "--alpha")
+			params.alpha = (int32_t)(value * 65536.0f);
+		else if (arg == "--beta")
+			params.beta = (int32_t)(value * 65536.0f);
+		else if (arg == "--process-noise")
+			params.process_noise = (int32_t)(value * 65536.0f);
+		else if (arg == "--measure-noise")
+			params.measure_noise = (int32_t)(value * 65536.0f);
+		else {
+			printf("Unknown option %s\n", arg.c_str());
+			return 1;
+		}
+	}
+
+	const std::pair<const char*, PredictorType> predictors[] = {
+		{ "D2DX", PredictorType::D2DX },
+		{ "Alpha-Beta", PredictorType::AlphaBeta },
+		{ "Kalman", PredictorType::Kalman },
+	};
+
+	printf("%-12s %8s %10s %10s %10s %10s %10s %10s %10s %10s\n", "predictor", "frames", "err avg", "err max", "jit avg", "jit max", "unit snap", "part snap", "particles", "us/frame");
+	for (const auto& predictor : predictors) {
+		params.type = predictor.second;
+
+		ReplayStats stats;
+		if (!replayMotion(argv[1], stats, params)) {
+			printf("Could not read %s\n", argv[1]);
+			return 1;
+		}
+
+		printf("%-12s %8u %10.2f %10.2f %10.2f %10.2f %10u %10u %10llu %10.2f\n", predictor.first, stats.frames, stats.mean_error, stats.max_error, stats.mean_jitter, stats.max_jitter, stats.unit_snaps, stats.particle_snaps, (unsigned long long)stats.particle_samples, stats.cpu_us_per_frame);
+	}
+
+	return 0;
+}
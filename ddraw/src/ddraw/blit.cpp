@@ -0,0 +1,280 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "pch.h"
+#include "blit.h"
+
+#include <intrin.h>
+#include <immintrin.h>
+
+namespace d2gl::blit {
+
+namespace {
+
+struct SSE2 {
+	using V = __m128i;
+	static constexpr int size = 16;
+
+	static inline V load(const uint8_t* p) { return _mm_loadu_si128((const V*)p); }
+	static inline void store(uint8_t* p, V v) { _mm_storeu_si128((V*)p, v); }
+	static inline V set(uint32_t bpp, uint32_t c) { return bpp == 8 ? _mm_set1_epi8((char)c) : (bpp == 16 ? _mm_set1_epi16((short)c) : _mm_set1_epi32((int)c)); }
+	static inline V cmpeq(uint32_t bpp, V a, V b) { return bpp == 8 ? _mm_cmpeq_epi8(a, b) : (bpp == 16 ? _mm_cmpeq_epi16(a, b) : _mm_cmpeq_epi32(a, b)); }
+	static inline V select(V mask, V a, V b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+};
+
+struct AVX2 {
+	using V = __m256i;
+	static constexpr int size = 32;
+
+	static inline V load(const uint8_t* p) { return _mm256_loadu_si256((const V*)p); }
+	static inline void store(uint8_t* p, V v) { _mm256_storeu_si256((V*)p, v); }
+	static inline V set(uint32_t bpp, uint32_t c) { return bpp == 8 ? _mm256_set1_epi8((char)c) : (bpp == 16 ? _mm256_set1_epi16((short)c) : _mm256_set1_epi32((int)c)); }
+	static inline V cmpeq(uint32_t bpp, V a, V b) { return bpp == 8 ? _mm256_cmpeq_epi8(a, b) : (bpp == 16 ? _mm256_cmpeq_epi16(a, b) : _mm256_cmpeq_epi32(a, b)); }
+	static inline V select(V mask, V a, V b) { return _mm256_blendv_epi8(b, a, mask); }
+};
+
+ISA detectISA()
+{
+	int info[4] = { 0 };
+	__cpuid(info, 0);
+	const int max_id = info[0];
+
+	__cpuid(info, 1);
+	const bool sse2 = info[3] & (1 << 26);
+	const bool osxsave = info[2] & (1 << 27);
+	const bool avx = info[2] & (1 << 28);
+
+	if (max_id >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+			return ISA::AVX2;
+	}
+
+	return sse2 ? ISA::SSE2 : ISA::Scalar;
+}
+
+ISA g_isa = detectISA();
+
+// Scalar reference, also finishes the row tails of the vector kernels.
+template <typename T>
+inline void keyPixels(uint8_t* dst, const uint8_t* src, int count, uint32_t key)
+{
+	auto d = (T*)dst;
+	auto s = (const T*)src;
+	for (int i = 0; i < count; i++) {
+		if (s[i] != (T)key)
+			d[i] = s[i];
+	}
+}
+
+template <typename T>
+inline void fillPixels(uint8_t* dst, int count, uint32_t color)
+{
+	auto d = (T*)dst;
+	for (int i = 0; i < count; i++)
+		d[i] = (T)color;
+}
+
+inline void keyTail(uint8_t* dst, const uint8_t* src, int bytes, uint32_t bpp, uint32_t key)
+{
+	switch (bpp) {
+		case 8: keyPixels<uint8_t>(dst, src, bytes, key); break;
+		case 16: keyPixels<uint16_t>(dst, src, bytes / 2, key); break;
+		case 32: keyPixels<uint32_t>(dst, src, bytes / 4, key); break;
+	}
+}
+
+inline void fillTail(uint8_t* dst, int bytes, uint32_t bpp, uint32_t color)
+{
+	switch (bpp) {
+		case 8: memset(dst, (uint8_t)color, bytes); break;
+		case 16: fillPixels<uint16_t>(dst, bytes / 2, color); break;
+		case 32: fillPixels<uint32_t>(dst, bytes / 4, color); break;
+	}
+}
+
+template <typename S>
+void copyRow(uint8_t* dst, const uint8_t* src, int bytes)
+{
+	int i = 0;
+	for (; i + S::size <= bytes; i += S::size)
+		S::store(dst + i, S::load(src + i));
+	memcpy(dst + i, src + i, bytes - i);
+}
+
+template <typename S>
+void keyRow(uint8_t* dst, const uint8_t* src, int bytes, uint32_t bpp, uint32_t key)
+{
+	const auto vkey = S::set(bpp, key);
+
+	int i = 0;
+	for (; i + S::size <= bytes; i += S::size) {
+		const auto s = S::load(src + i);
+		S::store(dst + i, S::select(S::cmpeq(bpp, s, vkey), S::load(dst + i), s));
+	}
+	keyTail(dst + i, src + i, bytes - i, bpp, key);
+}
+
+template <typename S>
+void fillRow(uint8_t* dst, int bytes, uint32_t bpp, uint32_t color)
+{
+	const auto vcolor = S::set(bpp, color);
+
+	int i = 0;
+	for (; i + S::size <= bytes; i += S::size)
+		S::store(dst + i, vcolor);
+	fillTail(dst + i, bytes - i, bpp, color);
+}
+
+template <typename T>
+void stretchRow(uint8_t* dst, const uint8_t* src, const int* map, int count, const uint32_t* key)
+{
+	auto d = (T*)dst;
+	auto s = (const T*)src;
+	if (key) {
+		for (int i = 0; i < count; i++) {
+			if (s[map[i]] != (T)*key)
+				d[i] = s[map[i]];
+		}
+	} else {
+		for (int i = 0; i < count; i++)
+			d[i] = s[map[i]];
+	}
+}
+
+void stretchRow32AVX2(uint8_t* dst, const uint8_t* src, const int* map, int count)
+{
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const auto idx = _mm256_loadu_si256((const __m256i*)(map + i));
+		_mm256_storeu_si256((__m256i*)(dst + i * 4), _mm256_i32gather_epi32((const int*)src, idx, 4));
+	}
+	stretchRow<uint32_t>(dst + i * 4, src, map + i, count - i, nullptr);
+}
+
+template <typename S>
+void copyRect(const Rect& dst, const ConstRect& src, uint32_t bpp)
+{
+	const int bytes = dst.width * (bpp / 8);
+	for (int y = 0; y < dst.height; y++)
+		copyRow<S>(dst.data + y * dst.pitch, src.data + y * src.pitch, bytes);
+}
+
+template <typename S>
+void keyRect(const Rect& dst, const ConstRect& src, uint32_t bpp, uint32_t key)
+{
+	const int bytes = dst.width * (bpp / 8);
+	for (int y = 0; y < dst.height; y++)
+		keyRow<S>(dst.data + y * dst.pitch, src.data + y * src.pitch, bytes, bpp, key);
+}
+
+template <typename S>
+void fillRect(const Rect& dst, uint32_t bpp, uint32_t color)
+{
+	const int bytes = dst.width * (bpp / 8);
+	for (int y = 0; y < dst.height; y++)
+		fillRow<S>(dst.data + y * dst.pitch, bytes, bpp, color);
+}
+
+}
+
+ISA getISA()
+{
+	return g_isa;
+}
+
+void setISA(ISA isa)
+{
+	g_isa = std::min(isa, detectISA());
+}
+
+void copy(const Rect& dst, const ConstRect& src, uint32_t bpp)
+{
+	switch (g_isa) {
+		case ISA::AVX2: copyRect<AVX2>(dst, src, bpp); break;
+		case ISA::SSE2: copyRect<SSE2>(dst, src, bpp); break;
+		default:
+			for (int y = 0; y < dst.height; y++)
+				memcpy(dst.data + y * dst.pitch, src.data + y * src.pitch, dst.width * (bpp / 8));
+	}
+}
+
+void copyColorKey(const Rect& dst, const ConstRect& src, uint32_t bpp, uint32_t key)
+{
+	switch (g_isa) {
+		case ISA::AVX2: keyRect<AVX2>(dst, src, bpp, key); break;
+		case ISA::SSE2: keyRect<SSE2>(dst, src, bpp, key); break;
+		default:
+			for (int y = 0; y < dst.height; y++)
+				keyTail(dst.data + y * dst.pitch, src.data + y * src.pitch, dst.width * (bpp / 8), bpp, key);
+	}
+}
+
+void fill(const Rect& dst, uint32_t bpp, uint32_t color)
+{
+	switch (g_isa) {
+		case ISA::AVX2: fillRect<AVX2>(dst, bpp, color); break;
+		case ISA::SSE2: fillRect<SSE2>(dst, bpp, color); break;
+		default:
+			for (int y = 0; y < dst.height; y++)
+				fillTail(dst.data + y * dst.pitch, dst.width * (bpp / 8), bpp, color);
+	}
+}
+
+void stretch(const Rect& dst, const ConstRect& src, uint32_t bpp, const uint32_t* key)
+{
+	if (dst.width <= 0 || dst.height <= 0 || src.width <= 0 || src.height <= 0)
+		return;
+
+	std::vector<int> map(dst.width);
+	for (int x = 0; x < dst.width; x++)
+		map[x] = (int)((int64_t)x * src.width / dst.width);
+
+	const int bytes = dst.width * (bpp / 8);
+	int prev_sy = -1;
+	for (int y = 0; y < dst.height; y++) {
+		const int sy = (int)((int64_t)y * src.height / dst.height);
+		uint8_t* dst_row = dst.data + y * dst.pitch;
+		const uint8_t* src_row = src.data + sy * src.pitch;
+
+		// Vertical upscale repeats source rows, reuse the row just written.
+		if (!key && sy == prev_sy) {
+			const auto prev_row = dst_row - dst.pitch;
+			switch (g_isa) {
+				case ISA::AVX2: copyRow<AVX2>(dst_row, prev_row, bytes); break;
+				case ISA::SSE2: copyRow<SSE2>(dst_row, prev_row, bytes); break;
+				default: memcpy(dst_row, prev_row, bytes);
+			}
+			continue;
+		}
+		prev_sy = sy;
+
+		switch (bpp) {
+			case 8: stretchRow<uint8_t>(dst_row, src_row, map.data(), dst.width, key); break;
+			case 16: stretchRow<uint16_t>(dst_row, src_row, map.data(), dst.width, key); break;
+			case 32:
+				if (!key && g_isa == ISA::AVX2)
+					stretchRow32AVX2(dst_row, src_row, map.data(), dst.width);
+				else
+					stretchRow<uint32_t>(dst_row, src_row, map.data(), dst.width, key);
+				break;
+		}
+	}
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+namespace d2gl::blit {
+
+enum class ISA {
+	Scalar,
+	SSE2,
+	AVX2,
+};
+
+struct Rect {
+	uint8_t* data;
+	uint32_t pitch;
+	int width;
+	int height;
+};
+
+struct ConstRect {
+	const uint8_t* data;
+	uint32_t pitch;
+	int width;
+	int height;
+};
+
+ISA getISA();
+void setISA(ISA isa);
+
+void copy(const Rect& dst, const ConstRect& src, uint32_t bpp);
+void copyColorKey(const Rect& dst, const ConstRect& src, uint32_t bpp, uint32_t key);
+void fill(const Rect& dst, uint32_t bpp, uint32_t color);
+void stretch(const Rect& dst, const ConstRect& src, uint32_t bpp, const uint32_t* key = nullptr);
+
+}
@@ -49,6 +49,7 @@ ULONG __stdcall DirectDraw::Release()
 {
 	m_ref--;
 	if (m_ref == 0) {
+		dllShutdown();
 		delete this;
 		return 0;
 	}
@@ -33,6 +33,7 @@
 
 #include "pch.h"
 #include "surface.h"
+#include "blit.h"
 #include "direct_draw.h"
 #include "wrapper.h"
 
@@ -102,6 +103,7 @@ DirectDrawSurface::DirectDrawSurface(LPDDSURFACEDESC surface_desc)
 
 		if (!m_bitmap)
 			m_data = HeapAlloc(GetProcessHeap(), HEAP_ZERO_MEMORY, m_ypitch * (m_height + 200) * m_xpitch);
+		m_dib_data = m_data;
 
 		if (m_caps & DDSCAPS_PRIMARYSURFACE)
 			DDrawSurface = this;
@@ -125,6 +127,11 @@ DirectDrawSurface::DirectDrawSurface(LPDDSURFACEDESC surface_desc)
 
 		m_back_buffer = new DirectDrawSurface(&desc);
 		IDirectDrawSurface_AddRef(m_back_buffer);
+
+		if ((m_caps & DDSCAPS_PRIMARYSURFACE) && surface_desc->dwBackBufferCount == 1 && App.ddraw_zero_copy) {
+			m_back_buffer->m_zero_copy = true;
+			m_back_buffer->attachUploadSlice();
+		}
 	}
 }
 
@@ -133,6 +140,8 @@ DirectDrawSurface::~DirectDrawSurface()
 	if (DDrawSurface && (m_caps & DDSCAPS_PRIMARYSURFACE))
 		DDrawSurface = nullptr;
 
+	detachUploadSlice(false);
+
 	if (m_bitmap)
 		DeleteObject(m_bitmap);
 	else if (m_data)
@@ -230,58 +239,40 @@ HRESULT __stdcall DirectDrawSurface::Blt(LPRECT in_dst_rect, LPDIRECTDRAWSURFACE
 	const int dst_y = dst_rect.top;
 
 	if (m_data && (flags & DDBLT_COLORFILL) && dst_w > 0 && dst_h > 0) {
-		uint8_t* dst = (uint8_t*)m_data + (dst_x * m_xpitch) + (m_ypitch * dst_y);
-		uint8_t* first_row = dst;
-		uint32_t dst_pitch = dst_w * m_xpitch;
+		markDirty(dst_y, dst_y + dst_h);
+
+		const blit::Rect dst = { (uint8_t*)m_data + (dst_x * m_xpitch) + (m_ypitch * dst_y), m_ypitch, dst_w, dst_h };
+		blit::fill(dst, m_bpp, blt_fx->dwFillColor);
+	} else if (m_data && src_surface && src_surface->m_data && src_surface->m_bpp == m_bpp && src_w > 0 && src_h > 0 && dst_w > 0 && dst_h > 0) {
+		markDirty(dst_y, dst_y + dst_h);
+
+		bool keyed = false;
+		uint32_t key = 0;
+		if ((flags & DDBLT_KEYSRCOVERRIDE) && blt_fx) {
+			keyed = true;
+			key = blt_fx->ddckSrcColorkey.dwColorSpaceLowValue;
+		} else if ((flags & DDBLT_KEYSRC) && src_surface->m_has_color_key) {
+			keyed = true;
+			key = src_surface->m_color_key;
+		}
 
-		if (m_bpp == 8) {
-			const auto color = (uint8_t)blt_fx->dwFillColor;
+		const blit::Rect dst = { (uint8_t*)m_data + (dst_x * m_xpitch) + (m_ypitch * dst_y), m_ypitch, dst_w, dst_h };
+		blit::ConstRect src = { (uint8_t*)src_surface->m_data + (src_x * m_xpitch) + (src_surface->m_ypitch * src_y), src_surface->m_ypitch, src_w, src_h };
 
-			for (int i = 0; i < dst_h; i++) {
-				memset(dst, color, dst_pitch);
-				dst += m_ypitch;
-			}
-		} else if (m_bpp == 16) {
-			auto row1 = (uint16_t*)dst;
-			const auto color = (uint16_t)blt_fx->dwFillColor;
-
-			if ((color & 0xFF) == (color >> 8)) {
-				const auto c8 = (uint8_t)(color & 0xFF);
-
-				for (int i = 0; i < dst_h; i++) {
-					memset(dst, c8, dst_pitch);
-					dst += m_ypitch;
-				}
-			} else {
-				for (int i = 0; i < dst_w; i++)
-					row1[i] = color;
-
-				for (int i = 1; i < dst_h; i++) {
-					dst += m_ypitch;
-					memcpy(dst, first_row, dst_pitch);
-				}
-			}
-		} else if (m_bpp == 32) {
-			auto row1 = (uint32_t*)dst;
-			const auto color = blt_fx->dwFillColor;
-
-			if ((color & 0xFF) == ((color >> 8) & 0xFF) && (color & 0xFF) == ((color >> 16) & 0xFF) && (color & 0xFF) == ((color >> 24) & 0xFF)) {
-				const auto c8 = (uint8_t)(color & 0xFF);
-
-				for (int i = 0; i < dst_h; i++) {
-					memset(dst, c8, dst_pitch);
-					dst += m_ypitch;
-				}
-			} else {
-				for (int i = 0; i < dst_w; i++)
-					row1[i] = color;
-
-				for (int i = 1; i < dst_h; i++) {
-					dst += m_ypitch;
-					memcpy(dst, first_row, dst_pitch);
-				}
-			}
+		std::vector<uint8_t> temp;
+		if (src_surface == this) {
+			temp.resize(src_w * src_h * m_xpitch);
+			blit::copy({ temp.data(), src_w * m_xpitch, src_w, src_h }, src, m_bpp);
+			src = { temp.data(), src_w * m_xpitch, src_w, src_h };
 		}
+
+		if (src_w == dst_w && src_h == dst_h) {
+			if (keyed)
+				blit::copyColorKey(dst, src, m_bpp, key);
+			else
+				blit::copy(dst, src, m_bpp);
+		} else
+			blit::stretch(dst, src, m_bpp, keyed ? &key : nullptr);
 	}
 
 	return DD_OK;
@@ -344,15 +335,15 @@ HRESULT __stdcall DirectDrawSurface::BltFast(DWORD x, DWORD y, LPDIRECTDRAWSURFA
 	const int dst_h = dst_rect.bottom - dst_rect.top;
 
 	if (src_surface && dst_w > 0 && dst_h > 0) {
-		auto src = (uint8_t*)src_surface->m_data + (src_x * src_surface->m_xpitch) + (src_surface->m_ypitch * src_y);
-		auto dst = (uint8_t*)m_data + (dst_x * m_xpitch) + (m_ypitch * dst_y);
-		uint32_t dst_pitch = dst_w * m_xpitch;
-
-		for (int i = 0; i < dst_h; i++) {
-			memcpy(dst, src, dst_pitch);
-			src += src_surface->m_ypitch;
-			dst += m_ypitch;
-		}
+		markDirty(dst_y, dst_y + dst_h);
+
+		const blit::Rect dst = { (uint8_t*)m_data + (dst_x * m_xpitch) + (m_ypitch * dst_y), m_ypitch, dst_w, dst_h };
+		const blit::ConstRect src = { (uint8_t*)src_surface->m_data + (src_x * src_surface->m_xpitch) + (src_surface->m_ypitch * src_y), src_surface->m_ypitch, dst_w, dst_h };
+
+		if ((flags & DDBLTFAST_SRCCOLORKEY) && src_surface->m_has_color_key)
+			blit::copyColorKey(dst, src, m_bpp, src_surface->m_color_key);
+		else
+			blit::copy(dst, src, m_bpp);
 	}
 
 	return DD_OK;
@@ -363,20 +354,38 @@ HRESULT __stdcall DirectDrawSurface::Flip(LPDIRECTDRAWSURFACE surface, DWORD fla
 	if (m_back_buffer) {
 		const auto back_buffer = surface ? (DirectDrawSurface*)surface : m_back_buffer;
 
-		void* surface_data = m_data;
-		HBITMAP bitmap = m_bitmap;
-		HDC hdc = m_hdc;
+		if (back_buffer->m_upload_slice >= 0) {
+			// The finished frame already sits in an upload buffer, present it as is.
+			detachUploadSlice(false);
+			m_upload_slice = back_buffer->m_upload_slice;
+			m_data = back_buffer->m_data;
+
+			// The back buffer still points at the presented slice, attaching copies it over.
+			back_buffer->m_upload_slice = -1;
+			back_buffer->attachUploadSlice();
+		} else {
+			detachUploadSlice(false);
+
+			void* surface_data = m_dib_data;
+			HBITMAP bitmap = m_bitmap;
+			HDC hdc = m_hdc;
+
+			m_data = m_dib_data = back_buffer->m_dib_data;
+			m_bitmap = back_buffer->m_bitmap;
+			m_hdc = back_buffer->m_hdc;
 
-		m_data = back_buffer->m_data;
-		m_bitmap = back_buffer->m_bitmap;
-		m_hdc = back_buffer->m_hdc;
+			back_buffer->m_data = back_buffer->m_dib_data = surface_data;
+			back_buffer->m_bitmap = bitmap;
+			back_buffer->m_hdc = hdc;
 
-		back_buffer->m_data = surface_data;
-		back_buffer->m_bitmap = bitmap;
-		back_buffer->m_hdc = hdc;
+			if (!surface && m_back_buffer->m_back_buffer)
+				m_back_buffer->Flip(NULL, 0);
 
-		if (!surface && m_back_buffer->m_back_buffer)
-			m_back_buffer->Flip(NULL, 0);
+			if (back_buffer->m_zero_copy)
+				back_buffer->attachUploadSlice();
+		}
+
+		markDirty();
 	}
 
 	if (m_caps & DDSCAPS_PRIMARYSURFACE)
@@ -470,9 +479,71 @@ HRESULT __stdcall DirectDrawSurface::Lock(LPRECT dst_rect, LPDDSURFACEDESC surfa
 {
 	DDrawWrapper->onBufferClear();
 
+	if (m_caps & DDSCAPS_PRIMARYSURFACE)
+		detachUploadSlice(true);
+
+	if (dst_rect)
+		markDirty(dst_rect->top, dst_rect->bottom);
+	else
+		markDirty();
+
 	return GetSurfaceDesc(surface_desc);
 }
 
+void DirectDrawSurface::markDirty(LONG top, LONG bottom)
+{
+	top = std::max(top, 0L);
+	bottom = std::min(bottom, m_height);
+	if (top >= bottom)
+		return;
+
+	if (m_dirty_top >= m_dirty_bottom) {
+		m_dirty_top = top;
+		m_dirty_bottom = bottom;
+	} else {
+		m_dirty_top = std::min(m_dirty_top, top);
+		m_dirty_bottom = std::max(m_dirty_bottom, bottom);
+	}
+}
+
+void DirectDrawSurface::attachUploadSlice()
+{
+	if (!App.context || !m_dib_data || m_upload_slice >= 0)
+		return;
+
+	// After a flip the back buffer must keep the presented frame, the game may only redraw parts of it.
+	const void* data = m_data;
+	m_upload_slice = App.context->acquireUploadSlice(m_ypitch * (m_height + 200));
+	m_data = m_upload_slice >= 0 ? App.context->getUploadSlice(m_upload_slice) : m_dib_data;
+	if (m_data != data)
+		memcpy(m_data, data, m_ypitch * m_height);
+}
+
+void DirectDrawSurface::detachUploadSlice(bool keep_data)
+{
+	if (m_upload_slice < 0)
+		return;
+
+	if (keep_data)
+		memcpy(m_dib_data, m_data, m_ypitch * m_height);
+
+	if (App.context)
+		App.context->releaseUploadSlice(m_upload_slice);
+	m_upload_slice = -1;
+	m_data = m_dib_data;
+}
+
+HRESULT __stdcall DirectDrawSurface::SetColorKey(DWORD flags, LPDDCOLORKEY color_key)
+{
+	if (flags & DDCKEY_SRCBLT) {
+		m_has_color_key = color_key != nullptr;
+		if (color_key)
+			m_color_key = color_key->dwColorSpaceLowValue;
+	}
+
+	return DD_OK;
+}
+
 HRESULT __stdcall DirectDrawSurface::SetPalette(LPDIRECTDRAWPALETTE palette)
 {
 	if (palette) {
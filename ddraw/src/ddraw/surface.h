@@ -36,7 +36,10 @@ class DirectDrawSurface : public IDirectDrawSurface {
 	DWORD m_bpp = 0, m_flags = 0, m_caps = 0;
 
 	void* m_data = nullptr;
+	void* m_dib_data = nullptr;
 	DWORD m_xpitch = 0, m_ypitch = 0;
+	int m_upload_slice = -1;
+	bool m_zero_copy = false;
 
 	BitmapInfo256* m_bmi = nullptr;
 	HBITMAP m_bitmap = nullptr;
@@ -45,12 +48,26 @@ class DirectDrawSurface : public IDirectDrawSurface {
 	DirectDrawPalette* m_palette = nullptr;
 	DirectDrawSurface* m_back_buffer = nullptr;
 
+	LONG m_dirty_top = 0, m_dirty_bottom = 0;
+
+	DWORD m_color_key = 0;
+	bool m_has_color_key = false;
+
 public:
 	DirectDrawSurface(LPDDSURFACEDESC surface_desc);
 	~DirectDrawSurface();
 
 	inline const DirectDrawPalette* getPalette() { return m_palette; }
 	inline const uint8_t* getData() { return (uint8_t*)m_data; }
+	inline int getUploadSlice() { return m_upload_slice; }
+
+	void markDirty(LONG top, LONG bottom);
+	inline void markDirty() { markDirty(0, m_height); }
+	inline glm::ivec2 getDirtyRows() { return { m_dirty_top, m_dirty_bottom }; }
+	inline void clearDirty() { m_dirty_top = m_dirty_bottom = 0; }
+
+	void attachUploadSlice();
+	void detachUploadSlice(bool keep_data);
 
 	/*** IUnknown methods ***/
 	STDMETHOD(QueryInterface)(THIS_ REFIID riid, LPVOID FAR* ppvObj) { return DDERR_UNSUPPORTED; }
@@ -83,7 +100,7 @@ public:
 	STDMETHOD(ReleaseDC)(THIS_ HDC) { return DDERR_UNSUPPORTED; }
 	STDMETHOD(Restore)(THIS) { return DDERR_UNSUPPORTED; }
 	STDMETHOD(SetClipper)(THIS_ LPDIRECTDRAWCLIPPER) { return DDERR_UNSUPPORTED; }
-	STDMETHOD(SetColorKey)(THIS_ DWORD, LPDDCOLORKEY) { return DDERR_UNSUPPORTED; }
+	STDMETHOD(SetColorKey)(THIS_ DWORD, LPDDCOLORKEY);
 	STDMETHOD(SetOverlayPosition)(THIS_ LONG, LONG) { return DDERR_UNSUPPORTED; }
 	STDMETHOD(SetPalette)(THIS_ LPDIRECTDRAWPALETTE);
 	STDMETHOD(Unlock)(THIS_ LPVOID);
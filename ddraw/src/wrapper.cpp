@@ -49,10 +49,53 @@ void Wrapper::onBufferSwap(bool flip)
 		return;
 	m_swapped = true;
 
-	ctx->getCommandBuffer()->gameTextureUpdate((uint8_t*)DDrawSurface->getData(), { App.game.size.x, App.game.size.y }, App.game.bpp == 8 ? 1 : 4);
+	const uint32_t bit = App.game.bpp == 8 ? 1 : 4;
+	const auto data = (uint8_t*)DDrawSurface->getData();
+	auto rows = DDrawSurface->getDirtyRows();
+	DDrawSurface->clearDirty();
+
+	auto command_buffer = ctx->getCommandBuffer();
+	if (const int slice = DDrawSurface->getUploadSlice(); slice >= 0) {
+		ctx->retainUploadSlice(slice);
+		command_buffer->gameTextureSlice(slice, { App.game.size.x, App.game.size.y }, bit);
+		m_prev_rows.clear();
+		ctx->presentFrame();
+		return;
+	}
+
+	if (command_buffer->isResized() || m_prev_rows.size() != (size_t)App.game.size.x * App.game.size.y * bit || m_row_bit != bit) {
+		m_prev_rows.assign((size_t)App.game.size.x * App.game.size.y * bit, 0);
+		m_row_bit = bit;
+		rows = { 0, (int)App.game.size.y };
+		if (App.ddraw_row_hash)
+			diffRows(data, rows, bit);
+	} else if (App.ddraw_row_hash && rows.x < rows.y)
+		rows = diffRows(data, rows, bit);
+
+	if (rows.x < rows.y)
+		command_buffer->gameTextureUpdate(data, { App.game.size.x, rows.y - rows.x }, bit, rows.x);
 	ctx->presentFrame();
 }
 
+glm::ivec2 Wrapper::diffRows(const uint8_t* data, glm::ivec2 rows, uint32_t bit)
+{
+	const size_t pitch = App.game.size.x * bit;
+	glm::ivec2 changed = { rows.y, rows.x };
+
+	// Rows are compared in full against a copy of the last upload, a hash match could hide a changed row.
+	for (int y = rows.x; y < rows.y; y++) {
+		const uint8_t* row = data + y * pitch;
+		uint8_t* prev_row = m_prev_rows.data() + y * pitch;
+		if (memcmp(prev_row, row, pitch)) {
+			memcpy(prev_row, row, pitch);
+			changed.x = std::min(changed.x, y);
+			changed.y = y + 1;
+		}
+	}
+
+	return changed;
+}
+
 void Wrapper::updatePalette(const glm::vec4* data)
 {
 	static uint32_t old_hash = 0;
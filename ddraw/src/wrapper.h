@@ -31,6 +31,9 @@ class Wrapper {
 	Context* ctx;
 	bool m_swapped = true;
 
+	std::vector<uint8_t> m_prev_rows;
+	uint32_t m_row_bit = 0;
+
 public:
 	Wrapper();
 	~Wrapper() = default;
@@ -42,6 +45,9 @@ public:
 
 	static HRESULT setCooperativeLevel(HWND hwnd, DWORD flags);
 	static HRESULT setDisplayMode(DWORD width, DWORD height, DWORD bpp);
+
+private:
+	glm::ivec2 diffRows(const uint8_t* data, glm::ivec2 rows, uint32_t bit);
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+/*
+	D2GL: Diablo 2 LoD Glide/DDraw to OpenGL Wrapper.
+	Copyright (C) 2023  Bayaraa
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+
+// Fuzzes the SSE2 / AVX2 blit kernels against the scalar path over random widths, pitches,
+// row tails and misaligned pointers. Whole buffers are compared so writes past a row show up too.
+//
+// Build (VS developer prompt):
+//   cl /std:c++20 /O2 /EHsc /I. /I..\..\src\ddraw blit_test.cpp ..\..\src\ddraw\blit.cpp
+//
+// Usage:
+//   blit_test [iterations] [seed]
+
+#include "pch.h"
+#include "blit.h"
+
+using namespace d2gl;
+
+struct Buffer {
+	std::vector<uint8_t> data;
+	uint32_t offset = 0;
+	uint32_t pitch = 0;
+	int width = 0;
+	int height = 0;
+
+	inline uint8_t* ptr() { return data.data() + offset; }
+};
+
+struct Case {
+	const char* op;
+	uint32_t bpp;
+	Buffer src;
+	Buffer dst;
+	uint32_t value;
+	bool keyed;
+};
+
+std::mt19937 g_rng;
+
+inline int random(int min, int max)
+{
+	return min + (int)(g_rng() % (uint32_t)(max - min + 1));
+}
+
+Buffer makeBuffer(int width, int height, uint32_t bpp)
+{
+	Buffer buffer;
+	buffer.width = width;
+	buffer.height = height;
+	buffer.offset = random(0, 31);
+	buffer.pitch = width * (bpp / 8) + random(0, 3) * (bpp / 8) + (random(0, 1) ? random(0, 64) : 0);
+	buffer.data.resize(buffer.offset + buffer.pitch * height + 64);
+	for (auto& byte : buffer.data)
+		byte = (uint8_t)g_rng();
+
+	return buffer;
+}
+
+// Few distinct values so color keys actually match.
+void fillPattern(Buffer& buffer, uint32_t value)
+{
+	for (auto& byte : buffer.data)
+		byte = (g_rng() % 3) ? (uint8_t)g_rng() : (uint8_t)value;
+}
+
+void run(const Case& test, Buffer& dst)
+{
+	const blit::Rect dst_rect = { dst.ptr(), dst.pitch, dst.width, dst.height };
+	const blit::ConstRect src_rect = { test.src.data.data() + test.src.offset, test.src.pitch, test.src.width, test.src.height };
+
+	if (!strcmp(test.op, "copy"))
+		blit::copy(dst_rect, src_rect, test.bpp);
+	else if (!strcmp(test.op, "key"))
+		blit::copyColorKey(dst_rect, src_rect, test.bpp, test.value);
+	else if (!strcmp(test.op, "fill"))
+		blit::fill(dst_rect, test.bpp, test.value);
+	else
+		blit::stretch(dst_rect, src_rect, test.bpp, test.keyed ? &test.value : nullptr);
+}
+
+Case makeCase()
+{
+	static const char* ops[] = { "copy", "key", "fill", "stretch" };
+	static const uint32_t bpps[] = { 8, 16, 32 };
+
+	Case test;
+	test.op = ops[random(0, 3)];
+	test.bpp = bpps[random(0, 2)];
+	test.value = (uint32_t)g_rng();
+	if (test.bpp == 8)
+		test.value &= 0xFF;
+	else if (test.bpp == 16)
+		test.value &= 0xFFFF;
+	test.keyed = random(0, 1);
+
+	const int width = random(0, 1) ? random(1, 80) : random(1, 700);
+	const int height = random(1, 6);
+	test.dst = makeBuffer(width, height, test.bpp);
+	if (!strcmp(test.op, "stretch"))
+		test.src = makeBuffer(random(1, 2 * width), random(1, 2 * height), test.bpp);
+	else
+		test.src = makeBuffer(width, height, test.bpp);
+	fillPattern(test.src, test.value);
+
+	return test;
+}
+
+int main(int argc, char** argv)
+{
+	const int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+	g_rng.seed(argc > 2 ? (uint32_t)atoi(argv[2]) : 1);
+
+	std::vector<blit::ISA> isas;
+	for (auto isa : { blit::ISA::SSE2, blit::ISA::AVX2 }) {
+		blit::setISA(isa);
+		if (blit::getISA() == isa)
+			isas.push_back(isa);
+	}
+	printf("Testing %s\n", isas.size() == 2 ? "SSE2, AVX2" : (isas.empty() ? "nothing, no SIMD support" : "SSE2"));
+
+	int failures = 0;
+	for (int i = 0; i < iterations; i++) {
+		const Case test = makeCase();
+
+		Buffer expected = test.dst;
+		blit::setISA(blit::ISA::Scalar);
+		run(test, expected);
+
+		for (auto isa : isas) {
+			Buffer result = test.dst;
+			blit::setISA(isa);
+			run(test, result);
+			if (result.data == expected.data)
+				continue;
+
+			const auto diff = std::mismatch(result.data.begin(), result.data.end(), expected.data.begin()).first - result.data.begin();
+			printf("FAIL %s %s bpp %u, %dx%d pitch %u offset %u, src %dx%d pitch %u offset %u, first diff at byte %d\n",
+				isa == blit::ISA::AVX2 ? "AVX2" : "SSE2", test.op, test.bpp, test.dst.width, test.dst.height, test.dst.pitch, test.dst.offset,
+				test.src.width, test.src.height, test.src.pitch, test.src.offset, (int)diff - (int)test.dst.offset);
+			if (++failures >= 20)
+				return 1;
+		}
+	}
+
+	printf("%d cases, %d failures\n", iterations, failures);
+	return failures ? 1 : 0;
+}
@@ -222,6 +222,7 @@ FX_ENTRY void FX_CALL grGlideInit(void)
 
 FX_ENTRY void FX_CALL grGlideShutdown(void)
 {
+	dllShutdown();
 }
 
 // Unused functions
@@ -261,7 +261,14 @@ FxBool Wrapper::grLfbLock(GrLfbWriteMode_t write_mode, GrOriginLocation_t origin
 FxBool Wrapper::grLfbUnlock()
 {
 	App.game.screen = GameScreen::Movie;
-	ctx->getCommandBuffer()->gameTextureUpdate((uint8_t*)m_movie_buffer.lfbPtr, { 640, 480 }, 4);
+
+	auto command_buffer = ctx->getCommandBuffer();
+	if (command_buffer->isResized() || m_movie_row_hashes.empty())
+		m_movie_row_hashes.assign(480, 0);
+
+	const auto rows = diffMovieRows();
+	if (rows.x < rows.y)
+		command_buffer->gameTextureUpdate((uint8_t*)m_movie_buffer.lfbPtr, { 640, rows.y - rows.x }, 4, rows.x);
 
 	onBufferClear();
 	onBufferSwap();
@@ -269,6 +276,24 @@ FxBool Wrapper::grLfbUnlock()
 	return FXTRUE;
 }
 
+glm::ivec2 Wrapper::diffMovieRows()
+{
+	const auto data = (const uint8_t*)m_movie_buffer.lfbPtr;
+	const size_t pitch = m_movie_buffer.strideInBytes;
+	glm::ivec2 changed = { 480, 0 };
+
+	for (int y = 0; y < 480; y++) {
+		const uint32_t hash = helpers::hash(data + y * pitch, pitch);
+		if (m_movie_row_hashes[y] != hash) {
+			m_movie_row_hashes[y] = hash;
+			changed.x = std::min(changed.x, y);
+			changed.y = y + 1;
+		}
+	}
+
+	return changed;
+}
+
 GrContext_t Wrapper::grSstWinOpen(FxU32 hwnd, GrScreenResolution_t screen_resolution)
 {
 	if (App.video_test)
@@ -36,6 +36,7 @@ class Wrapper {
 	bool m_swapped = true;
 	uint32_t m_gamma_hash = 0;
 	GrLfbInfo_t m_movie_buffer = { 0 };
+	std::vector<uint32_t> m_movie_row_hashes;
 	std::unique_ptr<TextureManager> m_texture_manager;
 
 public:
@@ -67,6 +68,9 @@ public:
 	static const char* grGetString(FxU32 pname);
 
 	static uint32_t getTexSize(GrTexInfo* info, uint32_t& width, uint32_t& height);
+
+private:
+	glm::ivec2 diffMovieRows();
 };
 
 }
\ No newline at end of file